@@ -0,0 +1,507 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * Offline decoder of recorded AM audio, WAV or raw samples, on all the cores.
+ *
+ * The file is memory-mapped and cut in quiet stretches into segments of
+ * about -s seconds, which are decoded independently on the executor, each
+ * by a demod of libacarsdemod, the engine of the acars block. The records
+ * are printed in file order, each dated from its position in the recording,
+ * so that the output does not depend on the number of threads.
+ *
+ * usage: acars_file_decode [options] file...
+ */
+
+#include <acars/demod.h>
+#include "channel_decoder.h"
+#include "executor.h"
+#include "fixed_point.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+enum sample_format { FORMAT_FLOAT, FORMAT_S16, FORMAT_S8, FORMAT_U8 };
+
+const int sample_size[] = { 4, 2, 1, 1 };
+
+struct options {
+    float seuil = 3.0f;
+    int threads = -1;
+    double segment = 60.0;
+    bool raw = false;
+    sample_format format = FORMAT_FLOAT;
+    int rate = 0;
+    bool have_start = false;
+    double start = 0.0;
+    bool verbose = false;
+};
+
+// ----------------------------------------------------------------------------
+// The samples of the file, memory-mapped
+// ----------------------------------------------------------------------------
+struct recording {
+    std::string name;
+    void* map = MAP_FAILED;
+    size_t length = 0;
+    const char* data = nullptr; ///< first sample
+    size_t count = 0;           ///< samples
+    sample_format format = FORMAT_FLOAT;
+    int rate = 0;
+    struct timespec t0 = { 0, 0 }; ///< time of the first sample
+
+    ~recording()
+    {
+        if (map != MAP_FAILED) {
+            munmap(map, length);
+        }
+    }
+};
+
+uint32_t le32(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return uint32_t(u[0]) | (uint32_t(u[1]) << 8) | (uint32_t(u[2]) << 16) |
+           (uint32_t(u[3]) << 24);
+}
+
+uint16_t le16(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return uint16_t(u[0] | (u[1] << 8));
+}
+
+// RIFF header: mono PCM 8 or 16 bits or IEEE float, the data chunk to the
+// end of the file if its size is not set (recorded from a stream)
+void parse_wav(recording& r, const char* p, size_t len)
+{
+    if ((len < 12) || std::memcmp(p, "RIFF", 4) || std::memcmp(p + 8, "WAVE", 4)) {
+        throw std::invalid_argument(r.name + ": not a WAV file");
+    }
+    bool have_fmt = false;
+    int bits = 0;
+    size_t pos = 12;
+    while (pos + 8 <= len) {
+        const char* id = p + pos;
+        size_t size = le32(p + pos + 4);
+        pos += 8;
+        if (!std::memcmp(id, "fmt ", 4) && (size >= 16) && (pos + size <= len)) {
+            int tag = le16(p + pos);
+            int channels = le16(p + pos + 2);
+            r.rate = int(le32(p + pos + 4));
+            bits = le16(p + pos + 14);
+            if ((tag == 0xfffe) && (size >= 40)) {
+                tag = le16(p + pos + 24); // WAVE_FORMAT_EXTENSIBLE subformat
+            }
+            if (channels != 1) {
+                throw std::invalid_argument(r.name + ": " + std::to_string(channels) +
+                                            " channels, only mono is supported");
+            }
+            if ((tag == 1) && (bits == 16)) {
+                r.format = FORMAT_S16;
+            } else if ((tag == 1) && (bits == 8)) {
+                r.format = FORMAT_U8;
+            } else if ((tag == 3) && (bits == 32)) {
+                r.format = FORMAT_FLOAT;
+            } else {
+                throw std::invalid_argument(r.name + ": unsupported WAV format " +
+                                            std::to_string(tag) + ", " +
+                                            std::to_string(bits) + " bits");
+            }
+            have_fmt = true;
+        } else if (!std::memcmp(id, "data", 4)) {
+            if (!have_fmt) {
+                throw std::invalid_argument(r.name + ": WAV data before its format");
+            }
+            if ((size == 0) || (size > len - pos)) {
+                size = len - pos;
+            }
+            r.data = p + pos;
+            r.count = size / sample_size[r.format];
+            return;
+        }
+        pos += size + (size & 1);
+    }
+    throw std::invalid_argument(r.name + ": no WAV data");
+}
+
+void open_recording(recording& r, const options& opt)
+{
+    int fd = open(r.name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(r.name + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        throw std::runtime_error(r.name + ": " + std::strerror(errno));
+    }
+    r.length = size_t(st.st_size);
+    if (r.length > 0) {
+        r.map = mmap(nullptr, r.length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if ((r.length > 0) && (r.map == MAP_FAILED)) {
+        throw std::runtime_error(r.name + ": mmap: " + std::strerror(errno));
+    }
+    const char* p = static_cast<const char*>(r.map);
+    if (r.length > 0) {
+        // read once from start to end
+        madvise(r.map, r.length, MADV_SEQUENTIAL);
+    }
+
+    if (opt.raw) {
+        r.data = p;
+        r.format = opt.format;
+        r.count = r.length / sample_size[r.format];
+    } else {
+        parse_wav(r, p, r.length);
+    }
+    if (opt.rate > 0) {
+        r.rate = opt.rate;
+    }
+    if (r.rate < 9600) {
+        throw std::invalid_argument(r.name + ": the decoder needs a rate of at least "
+                                             "9600 Hz (-r)");
+    }
+
+    // by default the recording ended when the file was last written
+    double t0 = opt.have_start ? opt.start
+                               : double(st.st_mtime) - double(r.count) / r.rate;
+    r.t0.tv_sec = time_t(std::floor(t0));
+    r.t0.tv_nsec = long((t0 - std::floor(t0)) * 1e9);
+}
+
+// ----------------------------------------------------------------------------
+// Samples of a chunk in the format the detector takes
+// ----------------------------------------------------------------------------
+template <typename T>
+const T* aligned(const char* p, int n, std::vector<char>& buf)
+{
+    if ((reinterpret_cast<uintptr_t>(p) % alignof(T)) == 0) {
+        return reinterpret_cast<const T*>(p);
+    }
+    buf.resize(size_t(n) * sizeof(T));
+    std::memcpy(buf.data(), p, buf.size());
+    return reinterpret_cast<const T*>(buf.data());
+}
+
+const int8_t* signed8(const char* p, int n, std::vector<char>& buf)
+{
+    buf.resize(n);
+    for (int k = 0; k < n; k++) {
+        buf[k] = char(p[k] ^ 0x80);
+    }
+    return reinterpret_cast<const int8_t*>(buf.data());
+}
+
+float chunk_stddev(const recording& r, size_t first, int n, std::vector<char>& buf)
+{
+    const char* p = r.data + first * sample_size[r.format];
+    switch (r.format) {
+    case FORMAT_S16:
+        return stats_stddev(stats_s16(aligned<int16_t>(p, n, buf), n), n, 1.0f / 32768);
+    case FORMAT_S8:
+        return stats_stddev(stats_s8(reinterpret_cast<const int8_t*>(p), n), n,
+                            1.0f / 128);
+    case FORMAT_U8:
+        return stats_stddev(stats_s8(signed8(p, n, buf), n), n, 1.0f / 128);
+    default:
+        break;
+    }
+    const float* f = aligned<float>(p, n, buf);
+    double sum = 0.0, sumsq = 0.0;
+    for (int k = 0; k < n; k++) {
+        sum += f[k];
+        sumsq += double(f[k]) * f[k];
+    }
+    double avg = sum / n;
+    return float(std::sqrt(std::max(0.0, sumsq / n - avg * avg)));
+}
+
+// ----------------------------------------------------------------------------
+// split(): segment boundaries, in whole chunks
+// ----------------------------------------------------------------------------
+// After every multiple of the segment length, the cut goes in the middle of
+// the quietest QUIET consecutive chunks of the next SEARCH seconds: a burst
+// lasts less than a second, so they are noise, and the detector of the
+// segment before has flushed its burst there. The cuts depend on the file
+// only, not on the number of threads.
+const int QUIET = 4;
+const double SEARCH = 10.0;
+
+std::vector<size_t> split(const recording& r, int chunk, double segment)
+{
+    const size_t chunks = r.count / chunk;
+    const size_t every = std::max<size_t>(size_t(segment * r.rate / chunk), 2 * QUIET);
+    const size_t search = std::max<size_t>(size_t(SEARCH * r.rate / chunk), QUIET);
+    std::vector<size_t> cuts(1, 0);
+    std::vector<char> buf;
+    std::vector<float> sd;
+
+    for (size_t c = every; c + search < chunks; c = cuts.back() + every) {
+        sd.resize(search);
+        for (size_t k = 0; k < search; k++) {
+            sd[k] = chunk_stddev(r, (c + k) * chunk, chunk, buf);
+        }
+        size_t best = 0;
+        float best_peak = 1e30f;
+        for (size_t k = 0; k + QUIET <= search; k++) {
+            float peak = *std::max_element(&sd[k], &sd[k] + QUIET);
+            if (peak < best_peak) {
+                best_peak = peak;
+                best = k;
+            }
+        }
+        cuts.push_back(c + best + QUIET / 2);
+    }
+    cuts.push_back(chunks);
+    for (size_t& c : cuts) {
+        c *= chunk;
+    }
+    return cuts;
+}
+
+// ----------------------------------------------------------------------------
+// A segment: decoded on a worker, its records kept until it is printed
+// ----------------------------------------------------------------------------
+struct segment_job;
+
+struct batch {
+    const recording* rec;
+    float seuil;
+    bool verbose;
+    std::vector<std::unique_ptr<segment_job>> jobs;
+    std::mutex mutex;
+    std::condition_variable cond;
+};
+
+struct segment_job : executor::task {
+    batch* owner;
+    size_t first;
+    size_t last;
+    std::string text;
+    uint64_t records = 0;
+    uint64_t bursts = 0;
+    bool done = false;
+
+    void run() override;
+};
+
+// The samples of the segment as they are, a chunk at a time, the record
+// of each message kept
+void segment_job::run()
+{
+    const recording& r = *owner->rec;
+    demod::config cfg;
+    cfg.input = (r.format == FORMAT_S16) ? demod::INPUT_SHORT
+                : (r.format == FORMAT_FLOAT) ? demod::INPUT_FLOAT
+                                             : demod::INPUT_CHAR;
+    cfg.samp_rate = r.rate;
+    cfg.threshold = owner->seuil;
+    cfg.verbose = owner->verbose;
+    cfg.decode_threads = 0; // decoded in this worker, as soon as detected
+    // dated from the position in the file
+    cfg.stream_time = true;
+    cfg.start = r.t0;
+    long ns = r.t0.tv_nsec + long((first % r.rate) * 1000000000ULL / r.rate);
+    cfg.start.tv_sec += time_t(first / r.rate) + ns / 1000000000L;
+    cfg.start.tv_nsec = ns % 1000000000L;
+    demod dec(cfg);
+
+    const int n = int(dec.input_multiple());
+    std::vector<char> buf;
+    std::string out;
+    demod_message m;
+    for (size_t k = first; k + n <= last; k += n) {
+        const char* p = r.data + k * sample_size[r.format];
+        switch (r.format) {
+        case FORMAT_S16:
+            dec.push(aligned<int16_t>(p, n, buf), n);
+            break;
+        case FORMAT_S8:
+            dec.push(reinterpret_cast<const int8_t*>(p), n);
+            break;
+        case FORMAT_U8:
+            dec.push(signed8(p, n, buf), n);
+            break;
+        default:
+            dec.push(aligned<float>(p, n, buf), n);
+            break;
+        }
+        while (dec.pull(m)) {
+            out += m.record;
+            records++;
+        }
+    }
+    // a burst cut by the end of the file
+    dec.flush();
+    while (dec.pull(m)) {
+        out += m.record;
+        records++;
+    }
+
+    std::lock_guard<std::mutex> lock(owner->mutex);
+    text.swap(out);
+    bursts = dec.decoded();
+    done = true;
+    owner->cond.notify_all();
+}
+
+struct totals {
+    double seconds = 0.0;
+    uint64_t segments = 0;
+    uint64_t bursts = 0;
+    uint64_t records = 0;
+};
+
+void decode_file(const std::string& name,
+                 const options& opt,
+                 executor& exec,
+                 FILE* out,
+                 totals& t)
+{
+    recording r;
+    r.name = name;
+    open_recording(r, opt);
+
+    batch b;
+    b.rec = &r;
+    b.seuil = opt.seuil;
+    b.verbose = opt.verbose;
+    const int chunk = int(std::lround(double(channel_decoder::CHUNK) * r.rate /
+                                      channel_decoder::RATE));
+    std::vector<size_t> cuts = split(r, chunk, opt.segment);
+    for (size_t k = 0; k + 1 < cuts.size(); k++) {
+        b.jobs.emplace_back(new segment_job());
+        b.jobs.back()->owner = &b;
+        b.jobs.back()->first = cuts[k];
+        b.jobs.back()->last = cuts[k + 1];
+    }
+    for (auto& j : b.jobs) {
+        exec.submit(j.get());
+    }
+
+    // in file order, each segment as soon as it and those before are done
+    for (auto& j : b.jobs) {
+        std::unique_lock<std::mutex> lock(b.mutex);
+        b.cond.wait(lock, [&] { return j->done; });
+        std::fwrite(j->text.data(), 1, j->text.size(), out);
+        std::string().swap(j->text);
+        t.bursts += j->bursts;
+        t.records += j->records;
+    }
+    std::fflush(out);
+    t.seconds += double(r.count) / r.rate;
+    t.segments += b.jobs.size();
+}
+
+const char* usage =
+    "usage: acars_file_decode [options] file...\n"
+    "  -t threshold  detection threshold, as in the acars block (3)\n"
+    "  -j threads    decoding threads (one per core)\n"
+    "  -s seconds    length of the segments decoded in parallel (60)\n"
+    "  -f format     raw samples: float, s16, s8 or u8 (default: WAV)\n"
+    "  -r rate       sample rate, required for raw samples\n"
+    "  -T seconds    Unix time of the first sample (file time - duration)\n"
+    "  -v            decoder diagnostics on stderr\n";
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    options opt;
+    int c;
+    while ((c = getopt(argc, argv, "t:j:s:f:r:T:vh")) != -1) {
+        switch (c) {
+        case 't':
+            opt.seuil = float(std::atof(optarg));
+            break;
+        case 'j':
+            opt.threads = std::atoi(optarg);
+            break;
+        case 's':
+            opt.segment = std::atof(optarg);
+            break;
+        case 'f':
+            opt.raw = true;
+            if (!std::strcmp(optarg, "float")) {
+                opt.format = FORMAT_FLOAT;
+            } else if (!std::strcmp(optarg, "s16")) {
+                opt.format = FORMAT_S16;
+            } else if (!std::strcmp(optarg, "s8")) {
+                opt.format = FORMAT_S8;
+            } else if (!std::strcmp(optarg, "u8")) {
+                opt.format = FORMAT_U8;
+            } else {
+                std::fprintf(stderr, "unknown sample format %s\n%s", optarg, usage);
+                return 2;
+            }
+            break;
+        case 'r':
+            opt.rate = std::atoi(optarg);
+            break;
+        case 'T':
+            opt.have_start = true;
+            opt.start = std::atof(optarg);
+            break;
+        case 'v':
+            opt.verbose = true;
+            break;
+        default:
+            std::fputs(usage, stderr);
+            return (c == 'h') ? 0 : 2;
+        }
+    }
+    if ((optind >= argc) || (opt.raw && (opt.rate <= 0))) {
+        std::fputs(usage, stderr);
+        return 2;
+    }
+
+    executor exec(opt.threads);
+    totals t;
+    int status = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int k = optind; k < argc; k++) {
+        try {
+            decode_file(argv[k], opt, exec, stdout, t);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "acars_file_decode: %s\n", e.what());
+            status = 1;
+        }
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr,
+                 "%.0f s of signal in %lu segments, %lu bursts, %lu messages, "
+                 "%.2f s on %d threads (%.0fx real time)\n",
+                 t.seconds,
+                 (unsigned long)t.segments,
+                 (unsigned long)t.bursts,
+                 (unsigned long)t.records,
+                 elapsed,
+                 exec.workers(),
+                 (elapsed > 0.0) ? t.seconds / elapsed : 0.0);
+    return status;
+}
@@ -37,6 +37,26 @@ namespace acars {
      public:
       typedef std::shared_ptr<acars> sptr;
 
+      //! Format of the raw burst dumps written when saveall is set
+      enum dump_format {
+          DUMP_TEXT = 0, //!< five-column ASCII /tmp/%Y%m%d_%H%M%S_acars.dump
+          DUMP_SIGMF = 1 //!< float32 raw + complex64 tones, SigMF metadata
+      };
+
+      //! Type of the input stream
+      enum input_type {
+          INPUT_FLOAT = 0,   //!< AM-demodulated audio
+          INPUT_COMPLEX = 1, //!< complex baseband centered on the channel
+          INPUT_SHORT = 2,   //!< AM-demodulated audio, 16-bit integers
+          INPUT_CHAR = 3     //!< AM-demodulated audio, 8-bit integers
+      };
+
+      //! Which bursts are persisted when saveall is set
+      enum capture_policy {
+          CAPTURE_ALL = 0,   //!< every burst
+          CAPTURE_FAILED = 1 //!< bursts failing the sync or BCS check only
+      };
+
       /*!
        * \brief Return a shared_ptr to a new instance of acars::acars.
        *
@@ -44,9 +64,95 @@ namespace acars {
        * constructor is in a private implementation
        * class. acars::acars::make is the public interface for
        * creating new instances.
+       *
+       * \param seuil threshold, in units of the noise standard deviation
+       * \param filename log file, or prefix of the log segments
+       * \param saveall dump bursts to /tmp, see \p format and \p policy
+       * \param segment_size if > 0, log to preallocated memory-mapped
+       *        segments of this many bytes instead of appending to filename
+       * \param rotate_seconds start a new segment after this many seconds
+       *        (0: rotate on size only)
+       * \param fsync_interval seconds between two fdatasync() of the
+       *        current segment (0: leave it to the kernel writeback)
+       * \param format DUMP_TEXT or DUMP_SIGMF; dumps are written by a
+       *        background thread, bursts are dropped if it falls behind
+       * \param policy CAPTURE_ALL, or CAPTURE_FAILED to persist only the
+       *        bursts failing the sync or BCS check
+       * \param capture_depth number of recent bursts kept in memory
+       * \param capture_sample with CAPTURE_FAILED, also persist one
+       *        successful burst out of capture_sample (0: none)
+       * \param feed also send each message as a datagram to
+       *        "udp:<host>:<port>" or "unix:<path>" (empty: disabled)
+       * \param feed_interval seconds between two batched sendmmsg() of the
+       *        feed (0: one datagram sent per message, synchronously)
+       * \param dedup_window drop messages identical (registration, label,
+       *        block id, sequence number and text) to one output less than
+       *        this many seconds before (0: disabled)
+       * \param dedup_group blocks of a process giving the same group name
+       *        share their duplicate cache
+       * \param decode_threads workers of the decode executor shared by the
+       *        blocks of the process, so that work() only detects and
+       *        buffers (-1: one per core; the first block sets the number;
+       *        0: decode in work())
+       * \param decode_queue bursts waiting for a decode thread; further
+       *        bursts are dropped and counted
+       * \param input INPUT_FLOAT, or INPUT_COMPLEX to AM-demodulate,
+       *        DC-block and decimate complex baseband in the block, or
+       *        INPUT_SHORT / INPUT_CHAR for integer AM audio, full scale
+       *        32768 / 128, detected in fixed point
+       * \param samp_rate input sample rate, 9600 Hz or more; complex input
+       *        is decimated to 48, 24, 12 or 96 kHz when one of them
+       *        divides it. 12, 24, 48 and 96 kHz decode fastest
+       * \param stats_interval seconds between two dictionaries of counters
+       *        published on the "stats" message port and printed on the
+       *        console (0: none)
+       * \param metrics_port serve the counters and latency histograms of
+       *        the block in the Prometheus text format on
+       *        http://127.0.0.1:port/metrics (0: no); the first block sets
+       *        the port of the process
        */
-      static sptr make(float seuil, std::string filename, bool saveall);
+      static sptr make(float seuil, std::string filename, bool saveall,
+                       int segment_size = 0, int rotate_seconds = 0,
+                       float fsync_interval = 1.0,
+                       dump_format format = DUMP_TEXT,
+                       capture_policy policy = CAPTURE_ALL,
+                       int capture_depth = 8,
+                       int capture_sample = 0,
+                       std::string feed = "",
+                       float feed_interval = 0.001,
+                       float dedup_window = 0,
+                       std::string dedup_group = "acars",
+                       int decode_threads = -1,
+                       int decode_queue = 16,
+                       input_type input = INPUT_FLOAT,
+                       double samp_rate = 48000,
+                       float stats_interval = 10,
+                       int metrics_port = 0);
       virtual void set_seuil(float)=0;
+
+      //! Bursts waiting for a decode thread
+      virtual int queue_depth()=0;
+      //! Bursts dropped because the decode queue was full
+      virtual uint64_t dropped_bursts()=0;
+      /*!
+       * \brief Latency of the stages of the decoder since the start or the
+       * last call with \p reset: a table of the count, mean, percentiles
+       * and maximum of work(), detection, decode queue, FFT, slicing,
+       * framing and output, in microseconds. Also printed when the
+       * flowgraph stops.
+       */
+      virtual std::string stage_report(bool reset = false)=0;
+      /*!
+       * \brief Record a timeline of the decoder stages of all the blocks of
+       * the process, in rings of \p events_per_thread events, to be saved
+       * in the Chrome trace event format by write_trace(). See acars/trace.h;
+       * the ACARS_TRACE environment variable traces from the start and
+       * writes at exit.
+       */
+      virtual void start_trace(int events_per_thread = 65536)=0;
+      virtual void stop_trace()=0;
+      //! Write the recorded timeline to \p path, false on error
+      virtual bool write_trace(const std::string& path)=0;
     };
 
 } // namespace acars
@@ -0,0 +1,91 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_ACARS_DIVERSITY_H
+#define INCLUDED_ACARS_ACARS_DIVERSITY_H
+
+#include <gnuradio/sync_block.h>
+#include <acars/api.h>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+    /*!
+     * \brief ACARS decoder combining several receivers of the same channel
+     * \ingroup acars
+     *
+     * Each input is the AM-demodulated audio of one receiver or antenna on
+     * the same frequency, all on the same sample clock. Each has the burst
+     * detector and decoder of the acars block; the bursts received at the
+     * same time are then combined, so that every transmission gives exactly
+     * one record: the best copy with a valid BCS if any, else the frame
+     * sliced from the sum of the soft bits of all the copies.
+     */
+    class ACARS_API acars_diversity : virtual public gr::sync_block
+    {
+     public:
+      typedef std::shared_ptr<acars_diversity> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of acars::acars_diversity.
+       *
+       * \param seuil threshold, in units of the noise standard deviation
+       * \param receivers number of inputs, 2 or more
+       * \param samp_rate sample rate of the inputs, 9600 Hz or more
+       * \param filename log file
+       * \param window largest difference of arrival, in seconds, between
+       *        copies of one transmission
+       * \param feed also send each message as a datagram to
+       *        "udp:<host>:<port>" or "unix:<path>" (empty: disabled)
+       * \param dedup_window drop messages identical to one output less than
+       *        this many seconds before (0: disabled)
+       * \param dedup_group blocks of a process giving the same group name
+       *        share their duplicate cache
+       * \param decode_threads workers of the decode executor shared by the
+       *        blocks of the process (-1: one per core; the first block sets
+       *        the number; 0: decode in work())
+       * \param decode_queue bursts waiting for a decode thread; further
+       *        bursts are dropped and counted
+       */
+      static sptr make(float seuil,
+                       int receivers,
+                       double samp_rate,
+                       std::string filename,
+                       float window = 0.1,
+                       std::string feed = "",
+                       float dedup_window = 0,
+                       std::string dedup_group = "acars",
+                       int decode_threads = -1,
+                       int decode_queue = 16);
+      virtual void set_seuil(float)=0;
+
+      //! Transmissions output so far
+      virtual uint64_t transmissions()=0;
+      //! Of which recovered by soft combining, no copy having a valid BCS
+      virtual uint64_t combined()=0;
+      //! Bursts dropped because the decode queue was full
+      virtual uint64_t dropped_bursts()=0;
+    };
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_ACARS_DIVERSITY_H */
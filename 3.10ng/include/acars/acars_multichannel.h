@@ -0,0 +1,95 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_ACARS_MULTICHANNEL_H
+#define INCLUDED_ACARS_ACARS_MULTICHANNEL_H
+
+#include <gnuradio/sync_block.h>
+#include <acars/api.h>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+    /*!
+     * \brief ACARS decoder for several channels of one complex baseband stream
+     * \ingroup acars
+     *
+     * The channels are extracted by a single polyphase filter bank of
+     * samp_rate / channel_spacing branches, AM-demodulated and decimated to
+     * the 48 kHz of the acars decoder, each channel having its own detector
+     * and decoder state. The records are output as by the acars block, with
+     * an additional Channel= line.
+     */
+    class ACARS_API acars_multichannel : virtual public gr::sync_block
+    {
+     public:
+      typedef std::shared_ptr<acars_multichannel> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of acars::acars_multichannel.
+       *
+       * \param seuil threshold, in units of the noise standard deviation
+       * \param samp_rate input sample rate: a multiple of both
+       *        channel_spacing and 48 kHz, e.g. 2.4e6
+       * \param center_freq frequency of the input stream center, in Hz
+       * \param channels frequencies to decode, in Hz, on the channel_spacing
+       *        grid around center_freq and within the input band
+       * \param filename log file
+       * \param saveall dump the bursts of each channel to /tmp, in SigMF
+       * \param channel_spacing spacing of the filter bank channels, in Hz
+       * \param feed also send each message as a datagram to
+       *        "udp:<host>:<port>" or "unix:<path>" (empty: disabled)
+       * \param dedup_window drop messages identical to one output less than
+       *        this many seconds before (0: disabled)
+       * \param dedup_group blocks of a process giving the same group name
+       *        share their duplicate cache
+       * \param decode_threads workers of the decode executor shared by the
+       *        blocks of the process, so that work() only detects and
+       *        buffers (-1: one per core; the first block sets the number;
+       *        0: decode in work())
+       * \param decode_queue bursts waiting for a decode thread; further
+       *        bursts are dropped and counted
+       */
+      static sptr make(float seuil,
+                       double samp_rate,
+                       double center_freq,
+                       const std::vector<double>& channels,
+                       std::string filename,
+                       bool saveall = false,
+                       double channel_spacing = 25000,
+                       std::string feed = "",
+                       float dedup_window = 0,
+                       std::string dedup_group = "acars",
+                       int decode_threads = -1,
+                       int decode_queue = 16);
+      virtual void set_seuil(float)=0;
+
+      //! Bursts waiting for a decode thread
+      virtual int queue_depth()=0;
+      //! Bursts dropped because the decode queue was full
+      virtual uint64_t dropped_bursts()=0;
+    };
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_ACARS_MULTICHANNEL_H */
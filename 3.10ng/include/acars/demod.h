@@ -0,0 +1,218 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_DEMOD_H
+#define INCLUDED_ACARS_DEMOD_H
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief A frame decoded by demod, as returned by demod::pull().
+ */
+struct demod_message {
+    uint64_t offset;      ///< decoder sample index of the start of the burst
+    struct timespec time; ///< time of that sample
+    bool bcs_ok;          ///< the block check sequence matched
+    std::string frame;    ///< characters of the frame, parity removed
+    std::string record;   ///< the record, as written to the log
+};
+
+/*!
+ * \brief Counters of a demod since its creation, as returned by
+ * demod::stats().
+ */
+struct demod_stats {
+    uint64_t samples;          ///< decoder samples through the detector
+    uint64_t bursts_detected;
+    uint64_t bursts_decoded;   ///< demodulated and output
+    uint64_t sync_failures;    ///< bursts without the "+*" SYN SYN SOH start
+    uint64_t crc_failures;     ///< synced frames failing the BCS
+    double mean_burst_ms;      ///< length of the detected bursts
+    float noise_floor;         ///< standard deviation of the last quiet chunk
+    int queue_depth;           ///< bursts waiting for a decode thread
+    double cpu_per_burst_ms;   ///< decode thread CPU time per decoded burst
+    uint64_t dropped_bursts;   ///< decode queue full
+    uint64_t dropped_messages; ///< beyond max_pending, or not logged or sent
+    uint64_t duplicates;       ///< already output by a block of the dedup group
+};
+
+/*!
+ * \brief Latency of one stage of the decoder, as returned by
+ * demod::stage_latencies(), in microseconds.
+ *
+ * The stages are push (a push() call, the block's work()), detect (a chunk
+ * through the detector), queue (a burst waiting for a decode thread), fft,
+ * slice and frame (the demodulation of a burst), output (its parsing and
+ * logging) and latency (a burst from its detection to the end of its output,
+ * the queue included). With no decode threads, a burst is decoded and output within
+ * the detection of its last chunk, which push and detect then include. The
+ * percentiles are the upper bounds of log-spaced buckets, within 25 %.
+ */
+struct stage_latency {
+    const char* name;
+    uint64_t count; ///< times timed
+    double mean_us;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double max_us;
+};
+
+/*!
+ * \brief The ACARS decoder without GNU Radio: push samples, pull messages.
+ *
+ * This is the engine of the acars block (burst detector, decode pool,
+ * demodulator, slicer and output stage) behind a plain C++ interface, in
+ * libacarsdemod, which only needs VOLK and FFTW. push() takes the samples
+ * of one channel in any amount, of the type given in the configuration;
+ * the detector works on whole chunks and keeps the rest for the next call.
+ * Decoded frames go to the log file, the feed and the console as set in the
+ * configuration, and are queued for pull() if max_pending is not 0.
+ *
+ * push(), flush() and set_threshold() are called from one thread; pull()
+ * may be called from any thread.
+ */
+class demod
+{
+public:
+    //! Type of the pushed samples
+    enum input_type {
+        INPUT_FLOAT = 0,   //!< AM-demodulated audio
+        INPUT_COMPLEX = 1, //!< complex baseband centered on the channel
+        INPUT_SHORT = 2,   //!< AM-demodulated audio, full scale 32768
+        INPUT_CHAR = 3     //!< AM-demodulated audio, full scale 128
+    };
+
+    /*!
+     * \brief Settings of a demod, with the defaults of the acars block.
+     *
+     * See acars::make() for the meaning of the fields they share.
+     */
+    struct config {
+        input_type input = INPUT_FLOAT;
+        double samp_rate = 48000;
+        float threshold = 3.0f;
+        int decode_threads = 0; ///< 0: decode in push(), < 0: one per core
+        int decode_queue = 16;
+        std::string label;      ///< Channel= line of the records, if not empty
+
+        bool console = false;   ///< print the records and every burst on stdout
+        bool verbose = false;   ///< print every burst on stderr, without console
+        std::string filename;   ///< log file or segment prefix, empty: none
+        int segment_size = 0;
+        int rotate_seconds = 0;
+        float fsync_interval = 1.0f;
+        std::string feed;
+        float feed_interval = 0.001f;
+        float dedup_window = 0.0f;
+        std::string dedup_group = "acars";
+
+        bool saveall = false;   ///< raw burst capture
+        bool sigmf = false;     ///< SigMF dumps, else text
+        bool capture_failed = false;
+        int capture_depth = 8;
+        int capture_sample = 0;
+        std::string capture_dir = "/tmp";
+        std::string capture_tag;
+
+        //! Date the records from the sample index, index 0 being \p start,
+        //! instead of with the wall clock: for recordings
+        bool stream_time = false;
+        struct timespec start = { 0, 0 };
+
+        size_t max_pending = 1024; ///< messages kept for pull(), 0: none
+
+        //! Publish the counters in the Prometheus text format on
+        //! http://127.0.0.1:port/metrics, 0: no; one server per process,
+        //! on the port of the first demod asking for it
+        int metrics_port = 0;
+        std::string metrics_name; ///< channel label of the metrics, default demodN
+    };
+
+    /*!
+     * \throws std::invalid_argument if the decoder rate (the sample rate,
+     *         decimated for complex input) is not an integer of at least
+     *         9600 Hz
+     */
+    explicit demod(const config& cfg);
+    ~demod(); ///< waits for the bursts being decoded
+
+    demod(const demod&) = delete;
+    demod& operator=(const demod&) = delete;
+
+    //! Samples of the configured type; std::invalid_argument otherwise
+    void push(const float* in, size_t n);
+    void push(const std::complex<float>* in, size_t n);
+    void push(const int16_t* in, size_t n);
+    void push(const int8_t* in, size_t n);
+
+    //! The oldest decoded message not pulled yet, false if there is none
+    bool pull(demod_message& m);
+
+    /*!
+     * \brief End of the stream: the burst in progress is decoded, and the
+     * call returns once every burst has been output. push() may go on after.
+     */
+    void flush();
+
+    void set_threshold(float threshold);
+
+    //! Decoder sample rate, after the decimation of complex input
+    int rate() const;
+    //! Pushing multiples of this many samples avoids copies
+    size_t input_multiple() const;
+
+    uint64_t decoded() const;      ///< bursts decoded
+    uint64_t dropped() const;      ///< bursts dropped, decode queue full
+    uint64_t lost_messages() const; ///< messages dropped, max_pending reached
+    int queue_depth();
+    int max_queue_depth();
+    /*!
+     * \brief The counters of the detector, the decode pool and the output.
+     * They are kept by the threads that update them, without locks, and
+     * added up here; any thread may call it.
+     */
+    demod_stats stats() const;
+
+    //! Per-stage latencies since the start or the last reset; empty if the
+    //! library was built without ENABLE_STAGE_TIMING
+    std::vector<stage_latency> stage_latencies() const;
+    void reset_stage_latencies();
+    //! The same as a table, one line per stage
+    std::string stage_report() const;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> _impl;
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_DEMOD_H */
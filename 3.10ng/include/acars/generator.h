@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_GENERATOR_H
+#define INCLUDED_ACARS_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Fields of a synthetic ACARS block, see generator::frame().
+ *
+ * The defaults make a downlink with a message sequence number and a flight
+ * number, the layout message_output expects.
+ */
+struct acars_message {
+    char mode = '2';
+    std::string address = ".N12345"; ///< aircraft registration, 7 characters
+    char ack = 0x15;                 ///< NAK, or the acknowledged block id
+    std::string label = "H1";        ///< 2 characters
+    char block_id = '1';
+    std::string msn = "M01A";        ///< sequence number, 4 characters
+    std::string flight = "AB1234";   ///< flight number, 6 characters
+    std::string text = "HELLO WORLD";
+    bool etb = false;                ///< ends with ETB instead of ETX
+};
+
+/*!
+ * \brief Synthetic ACARS signals, as output by an AM receiver.
+ *
+ * Frames are built with their parity and BCS, preceded by the pre-key (all
+ * ones) and MSK-modulated at 2400 bit/s: a 2400 Hz bit repeats the previous
+ * data bit, a 1200 Hz bit inverts it, with a continuous phase. The channel
+ * adds white Gaussian noise, a level difference between the tones, a bit
+ * clock offset and drift, and a DC offset.
+ *
+ * Each add() appends a gap of noise then one burst to samples(); a gap of 0
+ * gives back-to-back bursts. The output only depends on the configuration
+ * and the calls made, for any sample rate.
+ */
+class generator
+{
+public:
+    struct config {
+        double samp_rate = 48000;
+        float amplitude = 0.3f;   ///< peak level of the 1200 Hz tone
+        //! Signal to noise ratio in the bit rate bandwidth (2400 Hz), that is
+        //! Eb/N0; infinite for no noise
+        float snr_db = 30.0f;
+        //! Level of the 2400 Hz tone relative to the 1200 Hz one, negative
+        //! for the usual de-emphasis of receivers
+        float imbalance_db = 0.0f;
+        double clock_ppm = 0.0;   ///< bit clock (and tone) frequency error
+        double drift_ppm_s = 0.0; ///< change of the clock error per second
+        float dc = 0.0f;          ///< offset added to every sample
+        int prekey_bits = 128;
+        double gap = 0.5;         ///< seconds of noise before each burst
+        //! If not 0, the gaps are lengthened so that the bursts start on a
+        //! multiple of this many samples, such as the detector chunk
+        int align = 0;
+        uint32_t seed = 1;
+    };
+
+    /*!
+     * \throws std::invalid_argument if the rate is below 9600 Hz or the
+     *         amplitude, gap, alignment or pre-key length is negative
+     */
+    explicit generator(const config& cfg);
+
+    /*!
+     * \brief The characters of a block as sent, parity included: "+*" SYN
+     * SYN SOH, the fields of \p m, ETX or ETB, the BCS and DEL.
+     *
+     * \throws std::invalid_argument if a fixed-size field has the wrong size
+     */
+    static std::vector<unsigned char> frame(const acars_message& m);
+
+    /*!
+     * \brief Append a gap then a burst carrying \p m.
+     *
+     * Returns the index of the first sample of the burst in the stream,
+     * counting the samples dropped by clear().
+     */
+    uint64_t add(const acars_message& m);
+    //! Append a gap then a burst carrying the characters of \p frame
+    uint64_t add(const std::vector<unsigned char>& frame);
+    //! Append \p seconds of noise
+    void add_noise(double seconds);
+
+    const std::vector<float>& samples() const { return _samples; }
+    //! Drop the samples, to generate a long stream by parts
+    void clear();
+
+private:
+    void bit(double cycles, float level);
+    float noise();
+
+    config _cfg;
+    double _sigma;    ///< noise standard deviation
+    float _level2400; ///< peak level of the 2400 Hz tone
+    double _phase;    ///< of the tone, in cycles
+    double _clock;    ///< end of the last bit, in samples from the burst start
+    size_t _first;    ///< first sample of the burst in _samples
+    uint64_t _dropped; ///< samples dropped by clear()
+    double _elapsed;  ///< seconds generated, for the drift
+    std::mt19937 _rng;
+    std::normal_distribution<float> _normal;
+    std::vector<float> _samples;
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_GENERATOR_H */
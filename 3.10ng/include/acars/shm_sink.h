@@ -0,0 +1,61 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_SHM_SINK_H
+#define INCLUDED_ACARS_SHM_SINK_H
+
+#include <gnuradio/sync_block.h>
+#include <acars/api.h>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+    /*!
+     * \brief Publishes a stream in a shared-memory ring for other processes
+     * \ingroup acars
+     *
+     * The items are written to the POSIX shared memory object /dev/shm/name,
+     * from which any number of acars::shm_source blocks, in other processes,
+     * read them. The sink never waits for its readers: a reader falling more
+     * than capacity items behind loses the oldest ones and counts them.
+     */
+    class ACARS_API shm_sink : virtual public gr::sync_block
+    {
+     public:
+      typedef std::shared_ptr<shm_sink> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of acars::shm_sink.
+       *
+       * \param name name of the ring; a ring of the same name is replaced
+       * \param itemsize size of a stream item in bytes
+       * \param capacity items in the ring, rounded up to whole pages
+       */
+      static sptr make(std::string name, size_t itemsize, size_t capacity = 1 << 20);
+
+      //! Items written since the start
+      virtual uint64_t items_written()=0;
+    };
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_SHM_SINK_H */
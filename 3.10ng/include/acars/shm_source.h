@@ -0,0 +1,61 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_SHM_SOURCE_H
+#define INCLUDED_ACARS_SHM_SOURCE_H
+
+#include <gnuradio/sync_block.h>
+#include <acars/api.h>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+    /*!
+     * \brief Reads the stream published by an acars::shm_sink of another process
+     * \ingroup acars
+     *
+     * The source attaches to the ring when it appears, starts with the
+     * items written from then on, and keeps its own read position, so that
+     * readers do not disturb each other nor the writer. When the writer
+     * exits or is restarted, the source attaches to the new ring. Items
+     * lost because this reader fell behind are counted by overruns().
+     */
+    class ACARS_API shm_source : virtual public gr::sync_block
+    {
+     public:
+      typedef std::shared_ptr<shm_source> sptr;
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of acars::shm_source.
+       *
+       * \param name name of the ring, as given to the shm_sink
+       * \param itemsize size of a stream item in bytes, as in the sink
+       */
+      static sptr make(std::string name, size_t itemsize);
+
+      //! Items lost because the writer lapped this reader
+      virtual uint64_t overruns()=0;
+    };
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_SHM_SOURCE_H */
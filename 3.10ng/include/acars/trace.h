@@ -0,0 +1,58 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_TRACE_H
+#define INCLUDED_ACARS_TRACE_H
+
+#include <cstddef>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Timeline of the decoder stages, in the Chrome trace event format.
+ *
+ * While tracing, every stage timed for demod::stage_latencies() (push,
+ * detect, fft, slice, frame, output) is also recorded as a complete event
+ * on the thread that ran it, with its channel, into a ring of \p
+ * events_per_thread events owned by that thread: recording takes no lock,
+ * and the oldest events are overwritten. A later trace_start() with another
+ * size applies to the threads that already have a ring too: each moves to
+ * a ring of the new size at its next event, and the events of its old ring
+ * are still written. The decode workers are named on the timeline.
+ * trace_write() saves the events as JSON, to be opened with chrome://tracing
+ * or ui.perfetto.dev.
+ *
+ * If ACARS_TRACE names a file when the first decoder is made, tracing
+ * starts then and the trace is written to that file when the process
+ * exits. Without ENABLE_STAGE_TIMING, nothing is recorded.
+ */
+void trace_start(size_t events_per_thread = 65536);
+//! Stop recording; the events are kept for trace_write()
+void trace_stop();
+bool trace_active();
+//! Write the recorded events to \p path, false on error
+bool trace_write(const std::string& path);
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_TRACE_H */
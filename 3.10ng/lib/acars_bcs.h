@@ -0,0 +1,68 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_BCS_H
+#define INCLUDED_ACARS_BCS_H
+
+#include <cstdint>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief ACARS Block Check Sequence: CRC-16/CCITT, reflected, initial value 0.
+ *
+ * The BCS covers the 8-bit characters (parity included) from the one
+ * following SOH up to and including ETX/ETB, and is sent LSB first. Running
+ * it over the text and the two BCS characters gives 0 on a valid block.
+ */
+inline uint16_t acars_bcs(const unsigned char* p, int len, uint16_t crc = 0)
+{
+    for (int i = 0; i < len; i++) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+/*!
+ * \brief Check the BCS of a frame starting with "+*" SYN SYN SOH.
+ *
+ * \p frame holds the 8-bit characters as received; returns false if no
+ * ETX/ETB is found or if the two following characters do not match.
+ */
+inline bool acars_bcs_ok(const unsigned char* frame, int len)
+{
+    const int text = 5; // first character after SOH
+    for (int k = text; k < len - 2; k++) {
+        unsigned char c = frame[k] & 0x7f;
+        if ((c == 0x03) || (c == 0x17)) {
+            return acars_bcs(frame + text, k + 3 - text) == 0;
+        }
+    }
+    return false;
+}
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_BCS_H */
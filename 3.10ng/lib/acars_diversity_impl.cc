@@ -0,0 +1,156 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "acars_diversity_impl.h"
+#include <gnuradio/io_signature.h>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace gr {
+namespace acars {
+
+// ----------------------------------------------------------------------------
+// Factory function: creates a shared_ptr of acars_diversity_impl
+// ----------------------------------------------------------------------------
+acars_diversity::sptr acars_diversity::make(float seuil,
+                                            int receivers,
+                                            double samp_rate,
+                                            std::string filename,
+                                            float window,
+                                            std::string feed,
+                                            float dedup_window,
+                                            std::string dedup_group,
+                                            int decode_threads,
+                                            int decode_queue)
+{
+    return gnuradio::make_block_sptr<acars_diversity_impl>(seuil,
+                                                           receivers,
+                                                           samp_rate,
+                                                           filename,
+                                                           window,
+                                                           feed,
+                                                           dedup_window,
+                                                           dedup_group,
+                                                           decode_threads,
+                                                           decode_queue);
+}
+
+// ----------------------------------------------------------------------------
+// Constructor
+// ----------------------------------------------------------------------------
+acars_diversity_impl::acars_diversity_impl(float seuil1,
+                                           int receivers,
+                                           double samp_rate,
+                                           std::string filename,
+                                           float window,
+                                           std::string feed,
+                                           float dedup_window,
+                                           std::string dedup_group,
+                                           int decode_threads,
+                                           int decode_queue)
+    : gr::sync_block("acars_diversity",
+                     gr::io_signature::make(receivers, receivers, sizeof(float)),
+                     gr::io_signature::make(0, 0, 0))
+{
+    if (receivers < 2) {
+        throw std::invalid_argument("acars_diversity: at least 2 receivers");
+    }
+    if ((samp_rate < 9600) || (std::fabs(samp_rate - std::lround(samp_rate)) > 1e-6)) {
+        throw std::invalid_argument("acars_diversity: the decoder needs an integer "
+                                    "rate of at least 9600 Hz");
+    }
+    if (window < 0.0f) {
+        throw std::invalid_argument("acars_diversity: window must be >= 0");
+    }
+    const int rate = int(std::lround(samp_rate));
+
+    _out.reset(new message_output(filename, 0, 0, 0.0f, feed, 0.001f,
+                                  dedup_window, dedup_group));
+    _combiner.reset(
+        new diversity_combiner(receivers, uint64_t(double(window) * rate), _out.get()));
+    _pool.reset(new decode_pool(decode_threads, decode_queue));
+    for (int k = 0; k < receivers; k++) {
+        _channels.emplace_back(
+            new channel_decoder(seuil1, rate, _out.get(), nullptr, _pool.get()));
+        _channels.back()->set_combiner(_combiner.get(), k);
+        _channels.back()->set_console(stdout);
+    }
+
+    std::printf("threshold value=%f, filename=%s, %d receivers\n",
+                seuil1,
+                filename.c_str(),
+                receivers);
+
+    // whole detector chunks on every input
+    set_output_multiple(_channels[0]->chunk());
+}
+
+acars_diversity_impl::~acars_diversity_impl() {}
+
+// ----------------------------------------------------------------------------
+// set_seuil(): callback for updating threshold externally
+// ----------------------------------------------------------------------------
+void acars_diversity_impl::set_seuil(float seuil1)
+{
+    std::printf("new threshold: %f\n", seuil1);
+    std::fflush(stdout);
+    for (auto& c : _channels) {
+        c->set_seuil(seuil1);
+    }
+}
+
+bool acars_diversity_impl::stop()
+{
+    // the bursts still being decoded, then the groups still waiting
+    _pool->wait();
+    _combiner->flush();
+    std::printf("decode pool: %lu bursts decoded, %lu dropped, max queue depth %d\n",
+                (unsigned long)_pool->decoded(),
+                (unsigned long)_pool->dropped(),
+                _pool->max_queued());
+    std::printf("diversity: %lu transmissions, %lu with a valid copy, %lu combined, "
+                "%lu failed\n",
+                (unsigned long)_combiner->transmissions(),
+                (unsigned long)_combiner->picked(),
+                (unsigned long)_combiner->combined(),
+                (unsigned long)_combiner->failed());
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// work(): one detector per receiver, then tell the combiner how far each is
+// ----------------------------------------------------------------------------
+int acars_diversity_impl::work(int noutput_items,
+                               gr_vector_const_void_star& input_items,
+                               gr_vector_void_star& output_items)
+{
+    const int chunk = _channels[0]->chunk();
+    const uint64_t offset = nitems_read(0);
+    for (int k = 0; k < noutput_items; k += chunk) {
+        for (size_t c = 0; c < _channels.size(); c++) {
+            const float* in = static_cast<const float*>(input_items[c]);
+            _channels[c]->process(in + k, chunk, offset + k);
+        }
+    }
+    // a receiver with nothing pending will not report a burst before here
+    for (size_t c = 0; c < _channels.size(); c++) {
+        if (_channels[c]->idle()) {
+            _combiner->settle(int(c), offset + noutput_items);
+        }
+    }
+
+    consume_each(noutput_items);
+
+    // Sink block: nothing produced
+    return 0;
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,72 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_ACARS_DIVERSITY_IMPL_H
+#define INCLUDED_ACARS_ACARS_DIVERSITY_IMPL_H
+
+#include <acars/acars_diversity.h>
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "diversity_combiner.h"
+#include "message_output.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+class acars_diversity_impl : public acars_diversity
+{
+private:
+    std::unique_ptr<message_output> _out;          ///< console, log, feed, dedup
+    std::unique_ptr<diversity_combiner> _combiner; ///< one record per transmission
+    std::vector<std::unique_ptr<channel_decoder>> _channels; ///< one per receiver
+    std::unique_ptr<decode_pool> _pool; ///< decode threads, stopped first
+
+public:
+    acars_diversity_impl(float seuil,
+                         int receivers,
+                         double samp_rate,
+                         std::string filename,
+                         float window,
+                         std::string feed,
+                         float dedup_window,
+                         std::string dedup_group,
+                         int decode_threads,
+                         int decode_queue);
+    ~acars_diversity_impl();
+
+    void set_seuil(float seuil1) override;
+    uint64_t transmissions() override { return _combiner->transmissions(); }
+    uint64_t combined() override { return _combiner->combined(); }
+    uint64_t dropped_bursts() override { return _pool->dropped(); }
+
+    bool stop() override;
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_ACARS_DIVERSITY_IMPL_H */
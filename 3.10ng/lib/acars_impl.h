@@ -22,43 +22,61 @@
 #define INCLUDED_ACARS_ACARS_IMPL_H
 
 #include <acars/acars.h>      // Base class (acars)
-#include <cstdio>            // for FILE*, std::printf, etc.
-#include <vector>            // for std::vector
+#include <acars/demod.h>
+#include <chrono>
+#include <memory>
 #include <string>
 
-#include <gnuradio/fft/fft.h>         // if you need fft classes
-#include <gnuradio/fft/fft_shift.h>   // remove if not used
-
 namespace gr {
 namespace acars {
 
+/*!
+ * The block is a thin wrapper: the decoder is a demod of libacarsdemod,
+ * whose messages go to the console and the log, not to pull().
+ */
 class acars_impl : public acars
 {
 private:
-    int   _Ntot;      ///< total number of samples accumulated
-    int   _N;         ///< number of items in the current work call
-    float _threshold; ///< running threshold
-    int   _savenum;   ///< flag to save raw data
-    int   _decompte;  ///< accumulate extra chunks if needed
-    float _seuil;     ///< user threshold multiplier
-    FILE* _FILE;      ///< output file pointer
+    std::unique_ptr<demod> _demod;
+    input_type _input;
+    float _stats_interval; ///< seconds, 0: no stats
+    std::chrono::steady_clock::time_point _next_stats;
 
-    // Using std::vector rather than raw pointers
-    std::vector<float> _d;       ///< buffer for raw data
-    std::vector<char>  _toutd;   ///< buffer for demod bits
-    std::vector<char>  _tout;    ///< buffer for final bits
-    std::vector<char>  _message; ///< buffer for message bytes
-    std::vector<char>  _somme;   ///< buffer for parity or other checks
-
-    void  acars_parse(char* message, int ends);
-    float remove_avgf(const float* d, float* out, int tot_len);
-    void  acars_dec(float* d, int N);
+    std::chrono::steady_clock::duration interval() const;
+    void publish_stats();
 
 public:
-    acars_impl(float seuil, std::string filename, bool saveall);
+    acars_impl(float seuil,
+               std::string filename,
+               bool saveall,
+               int segment_size,
+               int rotate_seconds,
+               float fsync_interval,
+               dump_format format,
+               capture_policy policy,
+               int capture_depth,
+               int capture_sample,
+               std::string feed,
+               float feed_interval,
+               float dedup_window,
+               std::string dedup_group,
+               int decode_threads,
+               int decode_queue,
+               input_type input,
+               double samp_rate,
+               float stats_interval,
+               int metrics_port);
     ~acars_impl();
 
     void set_seuil(float seuil1);
+    int queue_depth() override;
+    uint64_t dropped_bursts() override;
+    std::string stage_report(bool reset) override;
+    void start_trace(int events_per_thread) override;
+    void stop_trace() override;
+    bool write_trace(const std::string& path) override;
+
+    bool stop() override;
 
     // Core processing method
     int work(int noutput_items,
@@ -0,0 +1,232 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "acars_multichannel_impl.h"
+#include <gnuradio/filter/firdes.h>
+#include <gnuradio/io_signature.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace gr {
+namespace acars {
+
+// ----------------------------------------------------------------------------
+// Factory function: creates a shared_ptr of acars_multichannel_impl
+// ----------------------------------------------------------------------------
+acars_multichannel::sptr acars_multichannel::make(float seuil,
+                                                  double samp_rate,
+                                                  double center_freq,
+                                                  const std::vector<double>& channels,
+                                                  std::string filename,
+                                                  bool saveall,
+                                                  double channel_spacing,
+                                                  std::string feed,
+                                                  float dedup_window,
+                                                  std::string dedup_group,
+                                                  int decode_threads,
+                                                  int decode_queue)
+{
+    return gnuradio::make_block_sptr<acars_multichannel_impl>(seuil,
+                                                              samp_rate,
+                                                              center_freq,
+                                                              channels,
+                                                              filename,
+                                                              saveall,
+                                                              channel_spacing,
+                                                              feed,
+                                                              dedup_window,
+                                                              dedup_group,
+                                                              decode_threads,
+                                                              decode_queue);
+}
+
+// ----------------------------------------------------------------------------
+// Constructor
+// ----------------------------------------------------------------------------
+acars_multichannel_impl::acars_multichannel_impl(float seuil1,
+                                                 double samp_rate,
+                                                 double center_freq,
+                                                 const std::vector<double>& channels,
+                                                 std::string filename,
+                                                 bool saveall,
+                                                 double channel_spacing,
+                                                 std::string feed,
+                                                 float dedup_window,
+                                                 std::string dedup_group,
+                                                 int decode_threads,
+                                                 int decode_queue)
+    : gr::sync_block("acars_multichannel",
+                     gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                     gr::io_signature::make(0, 0, 0))
+    , _fill(0)
+    , _nout(0)
+{
+    if (channels.empty()) {
+        throw std::invalid_argument("acars_multichannel: empty channel list");
+    }
+    if (channel_spacing <= 0.0) {
+        throw std::invalid_argument("acars_multichannel: channel_spacing must be > 0");
+    }
+    _M = int(std::lround(samp_rate / channel_spacing));
+    _D = int(std::lround(samp_rate / channel_decoder::RATE));
+    if ((_M < 2) || (std::fabs(_M * channel_spacing - samp_rate) > 1e-3)) {
+        throw std::invalid_argument(
+            "acars_multichannel: samp_rate must be a multiple of channel_spacing");
+    }
+    if ((_D < 1) || (std::fabs(double(_D) * channel_decoder::RATE - samp_rate) > 1e-3)) {
+        throw std::invalid_argument(
+            "acars_multichannel: samp_rate must be a multiple of 48 kHz");
+    }
+
+    // Prototype low pass: the AM sidebands of a channel pass, the neighbours
+    // 25 kHz away are attenuated before the decimation folds them back. The
+    // filter is padded to whole branches and stored time-reversed, so that
+    // work() runs over contiguous input samples.
+    std::vector<float> h = filter::firdes::low_pass(1.0,
+                                                    samp_rate,
+                                                    0.32 * channel_spacing,
+                                                    0.4 * channel_spacing,
+                                                    fft::window::WIN_HAMMING);
+    _ntaps = int((h.size() + _M - 1) / _M) * _M;
+    h.resize(_ntaps, 0.0f);
+    _taps.assign(h.rbegin(), h.rend());
+    _acc.resize(_M);
+    _fft.reset(new fft::fft_complex_rev(_M));
+
+    _out.reset(new message_output(filename, 0, 0, 0.0f, feed, 0.001f,
+                                  dedup_window, dedup_group));
+    _pool.reset(new decode_pool(decode_threads, decode_queue));
+
+    std::printf("threshold value=%f, filename=%s\n", seuil1, filename.c_str());
+    _channels.reserve(channels.size());
+    for (double f : channels) {
+        double offset = f - center_freq;
+        long k = std::lround(offset / channel_spacing);
+        if (std::fabs(offset - k * channel_spacing) > 1.0) {
+            throw std::invalid_argument("acars_multichannel: channel " +
+                                        std::to_string(f) +
+                                        " Hz is not on the channel grid");
+        }
+        if (2 * std::labs(k) >= _M - 1) {
+            throw std::invalid_argument("acars_multichannel: channel " +
+                                        std::to_string(f) +
+                                        " Hz is outside of the input band");
+        }
+        char label[32];
+        std::snprintf(label, sizeof(label), "%.3f", f / 1e6);
+
+        channel c;
+        c.bin = int((k + _M) % _M);
+        if (saveall) {
+            c.dump.reset(new burst_dump(burst_dump::SIGMF,
+                                        burst_dump::CAPTURE_ALL,
+                                        0,
+                                        channel_decoder::RATE,
+                                        "/tmp",
+                                        std::to_string(unique_id()) + "_" + label,
+                                        8));
+        }
+        c.decoder.reset(
+            new channel_decoder(seuil1, channel_decoder::RATE, _out.get(), c.dump.get(),
+                                _pool.get(), label));
+        c.decoder->set_console(stdout);
+        c.chunk.resize(channel_decoder::CHUNK);
+        _channels.push_back(std::move(c));
+        std::printf("channel %s MHz: filter bank output %d of %d\n", label, int(k), _M);
+    }
+
+    // Every work call covers the filter length plus whole decimation periods
+    set_history(_ntaps);
+    set_output_multiple(_D);
+}
+
+// ----------------------------------------------------------------------------
+// Destructor
+// ----------------------------------------------------------------------------
+acars_multichannel_impl::~acars_multichannel_impl() {}
+
+// ----------------------------------------------------------------------------
+// set_seuil(): callback for updating threshold externally
+// ----------------------------------------------------------------------------
+void acars_multichannel_impl::set_seuil(float seuil1)
+{
+    std::printf("new threshold: %f\n", seuil1);
+    std::fflush(stdout);
+    for (channel& c : _channels) {
+        c.decoder->set_seuil(seuil1);
+    }
+}
+
+int acars_multichannel_impl::queue_depth() { return _pool->queued(); }
+
+uint64_t acars_multichannel_impl::dropped_bursts() { return _pool->dropped(); }
+
+bool acars_multichannel_impl::stop()
+{
+    std::printf("decode pool: %lu bursts decoded, %lu dropped, max queue depth %d\n",
+                (unsigned long)_pool->decoded(),
+                (unsigned long)_pool->dropped(),
+                _pool->max_queued());
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// work(): channelize, AM-demodulate and decimate, then run the decoders
+// ----------------------------------------------------------------------------
+int acars_multichannel_impl::work(int noutput_items,
+                                  gr_vector_const_void_star& input_items,
+                                  gr_vector_void_star& output_items)
+{
+    // in[0 .. _ntaps-2] is history, the new samples follow
+    const gr_complex* in = static_cast<const gr_complex*>(input_items[0]);
+    gr_complex* branches = _fft->get_inbuf();
+    const gr_complex* bins = _fft->get_outbuf();
+
+    // One output per channel every _D input samples: channel k is
+    //   y_k(t) = e^{-2j.pi.k.t/M} sum_p v_p(t) e^{2j.pi.k.p/M}
+    // with v_p(t) = sum_q h[p+qM] x[t-p-qM] the polyphase branches, so one
+    // inverse FFT of the M branch outputs gives all the channels, and the
+    // leading phase term vanishes in the AM demodulation |y_k|.
+    for (int s = _D - 1; s < noutput_items; s += _D) {
+        const gr_complex* w = in + s; // the _ntaps samples up to in[s + _ntaps - 1]
+        std::fill(_acc.begin(), _acc.end(), gr_complex(0.0f, 0.0f));
+        for (int q = 0; q < _ntaps; q += _M) {
+            const float* t = &_taps[q];
+            const gr_complex* x = w + q;
+            for (int r = 0; r < _M; r++) {
+                _acc[r] += t[r] * x[r];
+            }
+        }
+        for (int p = 0; p < _M; p++) {
+            branches[p] = _acc[_M - 1 - p];
+        }
+        _fft->execute();
+
+        for (channel& c : _channels) {
+            c.chunk[_fill] = std::abs(bins[c.bin]);
+        }
+        if (++_fill == channel_decoder::CHUNK) {
+            for (channel& c : _channels) {
+                c.decoder->process(c.chunk.data(), _fill, _nout);
+            }
+            _nout += _fill;
+            _fill = 0;
+        }
+    }
+
+    consume_each(noutput_items);
+
+    // Sink block: nothing produced
+    return 0;
+}
+
+} // namespace acars
+} // namespace gr
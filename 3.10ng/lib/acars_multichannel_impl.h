@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_ACARS_MULTICHANNEL_IMPL_H
+#define INCLUDED_ACARS_ACARS_MULTICHANNEL_IMPL_H
+
+#include <acars/acars_multichannel.h>
+#include "burst_dump.h"
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "message_output.h"
+#include <gnuradio/fft/fft.h>
+#include <gnuradio/gr_complex.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+class acars_multichannel_impl : public acars_multichannel
+{
+private:
+    struct channel {
+        int bin;                                  ///< filter bank output
+        std::unique_ptr<burst_dump> dump;         ///< raw capture ring if saveall
+        std::unique_ptr<channel_decoder> decoder; ///< burst detector
+        std::vector<float> chunk; ///< envelope samples waiting for the decoder
+    };
+
+    int _M;     ///< number of filter bank branches
+    int _D;     ///< decimation from samp_rate to channel_decoder::RATE
+    int _ntaps; ///< prototype filter length, a multiple of _M
+    std::vector<float> _taps;        ///< prototype filter, time-reversed
+    std::vector<gr_complex> _acc;    ///< branch outputs, in reverse order
+    std::unique_ptr<fft::fft_complex_rev> _fft; ///< branch outputs -> channels
+    std::unique_ptr<message_output> _out; ///< console, log, feed, dedup
+    std::vector<channel> _channels;
+    std::unique_ptr<decode_pool> _pool; ///< decode threads, stopped first
+    int _fill;      ///< samples in the chunk of every channel
+    uint64_t _nout; ///< samples per channel handed to the decoders so far
+
+public:
+    acars_multichannel_impl(float seuil,
+                            double samp_rate,
+                            double center_freq,
+                            const std::vector<double>& channels,
+                            std::string filename,
+                            bool saveall,
+                            double channel_spacing,
+                            std::string feed,
+                            float dedup_window,
+                            std::string dedup_group,
+                            int decode_threads,
+                            int decode_queue);
+    ~acars_multichannel_impl();
+
+    void set_seuil(float seuil1);
+    int queue_depth() override;
+    uint64_t dropped_bursts() override;
+
+    bool stop() override;
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_ACARS_MULTICHANNEL_IMPL_H */
@@ -0,0 +1,52 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "am_frontend.h"
+#include <volk/volk.h>
+#include <cmath>
+
+namespace gr {
+namespace acars {
+
+am_frontend::am_frontend(int decim, double out_rate, double dc_cutoff)
+    : _decim(decim > 0 ? decim : 1),
+      _alpha(float(1.0 - 2.0 * M_PI * dc_cutoff / out_rate)),
+      _prev_in(0.0f),
+      _prev_out(0.0f)
+{
+    _mag.resize(BLOCK * _decim);
+}
+
+void am_frontend::process(const std::complex<float>* in, int nout, float* out)
+{
+    const float scale = 1.0f / float(_decim);
+    float prev_in = _prev_in;
+    float prev_out = _prev_out;
+    for (int k = 0; k < nout; k += BLOCK) {
+        int n = (nout - k < BLOCK) ? nout - k : BLOCK;
+        volk_32fc_magnitude_32f(_mag.data(), in + size_t(k) * _decim, n * _decim);
+        const float* m = _mag.data();
+        for (int i = 0; i < n; i++) {
+            float acc = 0.0f;
+            for (int j = 0; j < _decim; j++) {
+                acc += m[j];
+            }
+            m += _decim;
+            float x = acc * scale;
+            prev_out = x - prev_in + _alpha * prev_out;
+            prev_in = x;
+            out[k + i] = prev_out;
+        }
+    }
+    _prev_in = prev_in;
+    _prev_out = prev_out;
+}
+
+} // namespace acars
+} // namespace gr
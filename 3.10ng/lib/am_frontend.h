@@ -0,0 +1,68 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_AM_FRONTEND_H
+#define INCLUDED_ACARS_AM_FRONTEND_H
+
+#include <complex>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief AM envelope of complex baseband, decimated and DC-blocked.
+ *
+ * For each output sample, the magnitudes of \p decim input samples are
+ * averaged (integrate and dump, which also low-passes the envelope), then
+ * the carrier is removed by a one-pole DC blocker
+ *   y[n] = x[n] - x[n-1] + alpha.y[n-1]
+ * running at the output rate. The input is processed in blocks that fit in
+ * the L1 cache: volk computes the magnitudes of a block into a small
+ * scratch buffer, which is reduced and filtered before the next block, so
+ * no intermediate stream is written to memory.
+ */
+class am_frontend
+{
+private:
+    static const int BLOCK = 64; ///< output samples per volk call
+
+    int _decim;
+    float _alpha;
+    float _prev_in;  ///< DC blocker state
+    float _prev_out;
+    std::vector<float> _mag; ///< magnitudes of one block
+
+public:
+    /*!
+     * \param decim input samples per output sample
+     * \param out_rate output sample rate, Hz
+     * \param dc_cutoff cutoff of the DC blocker, Hz
+     */
+    am_frontend(int decim, double out_rate, double dc_cutoff = 30.0);
+
+    //! Write \p nout samples to out from the nout * decim samples of in
+    void process(const std::complex<float>* in, int nout, float* out);
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_AM_FRONTEND_H */
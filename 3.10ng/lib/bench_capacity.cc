@@ -0,0 +1,346 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * How many 48 kHz channels a machine decodes in real time, for a given
+ * message rate, and with how much delay.
+ *
+ * Each channel is an acars block's engine (detector, decode pool on the
+ * shared executor, output stage) driven by its own thread, as a block is by
+ * its scheduler thread, with generated traffic or a recording. For each
+ * worker count:
+ *  - the channels are fed as fast as they go, doubling their number until
+ *    one channel gets less than real time: the sustained throughput is the
+ *    seconds of signal decoded per second, and the capacity estimate the
+ *    whole part of the best one;
+ *  - that many channels are then fed at the real-time pace, with the decode
+ *    queue of the block, and the delay from the end of each burst's
+ *    detection to its output is measured. Real time holds if no burst is
+ *    dropped, no feeder falls more than a second behind, and 99 % of the
+ *    bursts are output within a second.
+ *
+ * usage: bench_acars_capacity [-s seconds of traffic] [-m messages/min]
+ *                             [-n Eb/N0 dB] [-p seconds paced]
+ *                             [-w max workers] [-i recording.f32]
+ *                             [-j file.json]
+ *
+ * The recording is raw 32-bit float AM audio at 48 kHz; the channels read it
+ * from different places.
+ */
+
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "message_output.h"
+#include <acars/generator.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+const int RATE = channel_decoder::RATE;
+const int CHUNK = channel_decoder::CHUNK;
+const int BLOCK_QUEUE = 16; ///< default decode queue of the acars block
+
+typedef std::chrono::steady_clock steady;
+
+// ----------------------------------------------------------------------------
+// Traffic
+// ----------------------------------------------------------------------------
+// Messages of 0 to 220 characters at random times, \p per_minute on average
+std::vector<float> make_traffic(double seconds, double per_minute, float snr_db)
+{
+    generator::config cfg;
+    cfg.gap = 0.0;
+    cfg.snr_db = snr_db;
+    generator g(cfg);
+    std::mt19937 rng(1);
+    std::exponential_distribution<double> gap(per_minute / 60.0);
+    std::uniform_int_distribution<int> length(0, 220);
+    const size_t total = size_t(seconds * RATE);
+    for (int k = 0; g.samples().size() < total; k++) {
+        g.add_noise(gap(rng));
+        acars_message m;
+        m.msn[3] = char('A' + k % 26);
+        m.text.resize(size_t(length(rng)));
+        for (size_t c = 0; c < m.text.size(); c++) {
+            m.text[c] = char('A' + (k + c) % 26);
+        }
+        g.add(m);
+    }
+    g.add_noise(0.5);
+    return g.samples();
+}
+
+std::vector<float> read_recording(const char* path)
+{
+    FILE* f = std::fopen(path, "rb");
+    if (!f) {
+        std::perror(path);
+        std::exit(1);
+    }
+    std::vector<float> s;
+    float buf[4096];
+    size_t n;
+    while ((n = std::fread(buf, sizeof(float), 4096, f)) > 0) {
+        s.insert(s.end(), buf, buf + n);
+    }
+    std::fclose(f);
+    return s;
+}
+
+// ----------------------------------------------------------------------------
+// One run: N channels, W workers
+// ----------------------------------------------------------------------------
+// Delay of each burst from its submission to the pool to its output
+struct latency_log : burst_listener {
+    std::mutex mutex;
+    std::vector<double> ms;
+
+    void decoded(const burst& b, decode_status, const std::string&) override
+    {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          steady::now().time_since_epoch())
+                          .count();
+        std::lock_guard<std::mutex> lock(mutex);
+        ms.push_back(double(now - b.submitted) * 1e-6);
+    }
+
+    double percentile(double p)
+    {
+        if (ms.empty()) {
+            return 0.0;
+        }
+        size_t k = std::min(ms.size() - 1, size_t(p / 100.0 * double(ms.size())));
+        std::nth_element(ms.begin(), ms.begin() + k, ms.end());
+        return ms[k];
+    }
+};
+
+struct result {
+    int channels;
+    int workers;
+    bool paced;
+    double seconds;  ///< wall time
+    double signal;   ///< seconds of signal per channel
+    uint64_t decoded;
+    uint64_t dropped;
+    double max_lag;  ///< paced: most a feeder was behind, in seconds
+    double p50, p90, p99, pmax; ///< output delay, ms
+};
+
+std::vector<result> results;
+
+result run(int channels, int workers, const std::vector<float>& signal, double paced)
+{
+    // a paced run lasts \p paced seconds, with the queue of the block
+    const size_t len = signal.size() / CHUNK * CHUNK;
+    const size_t total = (paced > 0.0) ? size_t(paced * RATE) / CHUNK * CHUNK : len;
+    const int depth = (paced > 0.0) ? BLOCK_QUEUE : (1 << 16);
+
+    message_output out("", 0, 0, 0.0f, "", 0.0f, 0.0f, "bench", false);
+    latency_log log;
+    std::vector<std::unique_ptr<decode_pool>> pools;
+    std::vector<std::unique_ptr<channel_decoder>> decoders;
+    for (int c = 0; c < channels; c++) {
+        pools.emplace_back(new decode_pool(workers, depth));
+        decoders.emplace_back(
+            new channel_decoder(3.0f, RATE, &out, nullptr, pools.back().get()));
+        decoders.back()->set_listener(&log);
+    }
+
+    std::vector<double> lag(channels, 0.0);
+    auto t0 = steady::now();
+    std::vector<std::thread> feeders;
+    for (int c = 0; c < channels; c++) {
+        feeders.emplace_back([&, c] {
+            // the channels hear different parts of the traffic
+            size_t pos = (size_t(c) * 7919 * CHUNK) % len;
+            for (size_t k = 0; k < total; k += CHUNK) {
+                if (paced > 0.0) {
+                    auto due = t0 + std::chrono::duration_cast<steady::duration>(
+                                        std::chrono::duration<double>(double(k) / RATE));
+                    auto now = steady::now();
+                    if (now < due) {
+                        std::this_thread::sleep_until(due);
+                    } else {
+                        lag[c] = std::max(lag[c],
+                                          std::chrono::duration<double>(now - due).count());
+                    }
+                }
+                decoders[c]->process(&signal[pos], CHUNK, k);
+                pos = (pos + CHUNK == len) ? 0 : pos + CHUNK;
+            }
+        });
+    }
+    for (auto& f : feeders) {
+        f.join();
+    }
+
+    result r = {};
+    r.channels = channels;
+    r.workers = workers;
+    r.paced = paced > 0.0;
+    r.signal = double(total) / RATE;
+    for (auto& p : pools) {
+        p->wait();
+        r.decoded += p->decoded();
+        r.dropped += p->dropped();
+    }
+    r.seconds = std::chrono::duration<double>(steady::now() - t0).count();
+    r.max_lag = *std::max_element(lag.begin(), lag.end());
+    r.p50 = log.percentile(50);
+    r.p90 = log.percentile(90);
+    r.p99 = log.percentile(99);
+    r.pmax = log.percentile(100);
+    decoders.clear();
+    pools.clear(); // the executor goes with the last pool
+    results.push_back(r);
+    return r;
+}
+
+void print(const result& r)
+{
+    double rt = r.channels * r.signal / r.seconds;
+    std::fprintf(stderr,
+                 "%-6s %8d %7d %8.1f %11.2f %8lu %7lu %8.1f %8.1f %8.1f %8.1f",
+                 r.paced ? "paced" : "fast", r.channels, r.workers, rt, rt / r.channels,
+                 (unsigned long)r.decoded, (unsigned long)r.dropped, r.p50, r.p90, r.p99,
+                 r.pmax);
+    if (r.paced) {
+        std::fprintf(stderr, "  lag %.3f s", r.max_lag);
+    }
+    std::fprintf(stderr, "\n");
+}
+
+void write_json(const char* path, double per_minute)
+{
+    FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::perror(path);
+        std::exit(1);
+    }
+    std::fprintf(f,
+                 "{\n  \"context\": {\n"
+                 "    \"executable\": \"bench_acars_capacity\",\n"
+                 "    \"num_cpus\": %u,\n"
+                 "    \"sample_rate\": %d,\n"
+                 "    \"messages_per_minute\": %.1f\n"
+                 "  },\n  \"runs\": [\n",
+                 std::thread::hardware_concurrency(), RATE, per_minute);
+    for (size_t k = 0; k < results.size(); k++) {
+        const result& r = results[k];
+        double rt = r.channels * r.signal / r.seconds;
+        std::fprintf(f,
+                     "    { \"mode\": \"%s\", \"channels\": %d, \"workers\": %d, "
+                     "\"x_real_time\": %.3f, \"per_channel\": %.3f, "
+                     "\"decoded\": %lu, \"dropped\": %lu, \"max_lag_s\": %.4f, "
+                     "\"latency_ms\": { \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, "
+                     "\"max\": %.3f } }%s\n",
+                     r.paced ? "paced" : "fast", r.channels, r.workers, rt,
+                     rt / r.channels, (unsigned long)r.decoded, (unsigned long)r.dropped,
+                     r.max_lag, r.p50, r.p90, r.p99, r.pmax,
+                     (k + 1 < results.size()) ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double seconds = 60.0;
+    double per_minute = 20.0;
+    float snr_db = 30.0f;
+    double paced = 20.0;
+    int cores = int(std::thread::hardware_concurrency());
+    int max_workers = cores;
+    const char* recording = nullptr;
+    const char* json = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:m:n:p:w:i:j:")) != -1) {
+        switch (opt) {
+        case 's':
+            seconds = std::atof(optarg);
+            break;
+        case 'm':
+            per_minute = std::atof(optarg);
+            break;
+        case 'n':
+            snr_db = float(std::atof(optarg));
+            break;
+        case 'p':
+            paced = std::atof(optarg);
+            break;
+        case 'w':
+            max_workers = std::atoi(optarg);
+            break;
+        case 'i':
+            recording = optarg;
+            break;
+        case 'j':
+            json = optarg;
+            break;
+        default:
+            std::fprintf(stderr,
+                         "usage: %s [-s seconds] [-m messages/min] [-n Eb/N0 dB] "
+                         "[-p seconds paced] [-w max workers] [-i recording.f32] "
+                         "[-j file.json]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<float> signal = recording ? read_recording(recording)
+                                          : make_traffic(seconds, per_minute, snr_db);
+    if (signal.size() < size_t(CHUNK)) {
+        std::fprintf(stderr, "not enough signal\n");
+        return 1;
+    }
+
+    std::fprintf(stderr,
+                 "%.0f s of %s per channel, %d cores\n"
+                 "mode   channels workers  x real  per channel   bursts dropped"
+                 "   p50 ms   p90 ms   p99 ms   max ms\n",
+                 double(signal.size()) / RATE,
+                 recording ? recording : "generated traffic", cores);
+    for (int workers = 1; workers <= max_workers; workers *= 2) {
+        double best = 0.0;
+        for (int channels = 1;; channels *= 2) {
+            result r = run(channels, workers, signal, 0.0);
+            print(r);
+            double rt = channels * r.signal / r.seconds;
+            best = std::max(best, rt);
+            if (rt / channels < 1.0) {
+                break;
+            }
+        }
+        int capacity = int(best);
+        if ((capacity > 0) && (paced > 0.0)) {
+            result r = run(capacity, workers, signal, paced);
+            print(r);
+            bool held = (r.dropped == 0) && (r.max_lag < 1.0) && (r.p99 < 1000.0);
+            std::fprintf(stderr, "%d workers: %d channels %s real time\n", workers,
+                         capacity, held ? "hold" : "lose");
+        }
+    }
+
+    if (json) {
+        write_json(json, per_minute);
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * Decode throughput of N channels on the shared executor, for a range of
+ * worker counts: each channel is driven by its own thread (as a block is by
+ * its scheduler thread) with a synthetic stream of 0.5 s bursts separated by
+ * 0.5 s of noise, as fast as it can go.
+ *
+ * usage: bench_acars_executor [seconds of signal per channel]
+ */
+
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "message_output.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace gr::acars;
+
+static std::vector<float> make_signal(int seconds)
+{
+    const int rate = channel_decoder::RATE;
+    std::vector<float> s(size_t(seconds) * rate);
+    unsigned seed = 1;
+    for (size_t t = 0; t < s.size(); t++) {
+        seed = seed * 1103515245u + 12345u;
+        float noise = 0.05f * (float((seed >> 16) & 0x7fff) / 16384.0f - 1.0f);
+        bool on = (t % rate) < size_t(rate / 2);
+        // 1200/2400 Hz keyed at 2400 bit/s, roughly what acars_dec() sees
+        float f = ((t / 20) & 1) ? 2400.0f : 1200.0f;
+        s[t] = noise + (on ? std::sin(2.0f * float(M_PI) * f * t / rate) : 0.0f);
+    }
+    return s;
+}
+
+struct result {
+    double seconds;
+    uint64_t decoded;
+    uint64_t dropped;
+};
+
+static result run(int channels, int workers, const std::vector<float>& signal)
+{
+    message_output out("/dev/null", 0, 0, 0.0f, "", 0.0f, 0.0f, "bench", false);
+    std::vector<std::unique_ptr<decode_pool>> pools;
+    std::vector<std::unique_ptr<channel_decoder>> decoders;
+    for (int c = 0; c < channels; c++) {
+        pools.emplace_back(new decode_pool(workers, 1 << 16));
+        decoders.emplace_back(
+            new channel_decoder(3.0f, channel_decoder::RATE, &out, nullptr, pools.back().get()));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> feeders;
+    for (int c = 0; c < channels; c++) {
+        feeders.emplace_back([&, c] {
+            const int n = channel_decoder::CHUNK;
+            for (size_t k = 0; k + n <= signal.size(); k += n) {
+                decoders[c]->process(&signal[k], n, k);
+            }
+        });
+    }
+    for (auto& f : feeders) {
+        f.join();
+    }
+    result r{ 0.0, 0, 0 };
+    for (auto& p : pools) {
+        p->wait();
+        r.decoded += p->decoded();
+        r.dropped += p->dropped();
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    pools.clear(); // the executor goes with the last pool
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    int seconds = (argc > 1) ? std::atoi(argv[1]) : 60;
+    int cores = int(std::thread::hardware_concurrency());
+    std::vector<float> signal = make_signal(seconds);
+
+    std::fprintf(stderr,
+                 "%d s of signal per channel, %d cores\n"
+                 "channels workers  bursts/s  x real time  per channel  dropped\n",
+                 seconds, cores);
+    for (int channels = 1; channels <= 4 * cores; channels *= 2) {
+        for (int workers = 1; workers <= cores; workers *= 2) {
+            result r = run(channels, workers, signal);
+            double rt = double(channels) * seconds / r.seconds;
+            std::fprintf(stderr, "%8d %7d %9.1f %12.1f %12.1f %8lu\n",
+                         channels, workers, r.decoded / r.seconds, rt,
+                         rt / channels, (unsigned long)r.dropped);
+        }
+    }
+    return 0;
+}
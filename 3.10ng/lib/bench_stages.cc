@@ -0,0 +1,387 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * Cost of each stage of the decoder, on one core, with generated signals:
+ * the detector (mean removal, then a whole chunk on noise for each input
+ * type), acars_dec() for a range of burst lengths, the tone correlation of
+ * acars_dec() against two time-domain alternatives, the bit slicer, the
+ * byte assembly and BCS check, and the formatting of a record.
+ *
+ * Each benchmark runs batches of at least the given time and reports the
+ * median time of an iteration (a chunk, a burst, a message) and the same
+ * per sample, bit or message. The table goes to stderr and, with -j, the
+ * results to a JSON file in the layout of Google Benchmark, so that the
+ * usual comparison tools apply.
+ *
+ * usage: bench_acars_stages [-j file.json] [-t seconds per batch]
+ *                           [-f name filter]
+ */
+
+#include "burst_decoder.h"
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "fft_plan.h"
+#include "message_output.h"
+#include <acars/generator.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+const int RATE = channel_decoder::RATE;
+
+struct result {
+    std::string name;
+    std::string unit;    ///< what one iteration processes
+    double units;        ///< of them per iteration
+    uint64_t iterations; ///< per batch
+    double ns;           ///< median time of an iteration
+};
+
+double min_time = 0.1;
+std::string filter;
+std::vector<result> results;
+
+// Time \p f in batches: the batch size is doubled until a batch takes
+// min_time, then 5 batches are timed and the median kept
+void bench(const std::string& name,
+           const std::string& unit,
+           double units,
+           const std::function<void()>& f)
+{
+    if (!filter.empty() && (name.find(filter) == std::string::npos)) {
+        return;
+    }
+    typedef std::chrono::steady_clock clock;
+    auto batch = [&f](uint64_t n) {
+        auto t0 = clock::now();
+        for (uint64_t k = 0; k < n; k++) {
+            f();
+        }
+        return std::chrono::duration<double>(clock::now() - t0).count();
+    };
+    uint64_t n = 1;
+    while (batch(n) < min_time) {
+        n *= 2;
+    }
+    std::vector<double> t;
+    for (int r = 0; r < 5; r++) {
+        t.push_back(batch(n) * 1e9 / double(n));
+    }
+    std::sort(t.begin(), t.end());
+    results.push_back(result{ name, unit, units, n, t[2] });
+    std::fprintf(stderr, "%-34s %12.1f ns %10.3f ns/%s\n", name.c_str(), t[2],
+                 t[2] / units, unit.c_str());
+}
+
+// One burst, as the detector hands it to the decoder
+burst make_burst(size_t text)
+{
+    generator::config cfg;
+    cfg.gap = 0.0;
+    generator g(cfg);
+    acars_message m;
+    m.text.assign(text, 'A');
+    for (size_t k = 0; k < text; k++) {
+        m.text[k] = char('A' + k % 26);
+    }
+    g.add(m);
+    g.add_noise(0.01);
+
+    burst b;
+    b.rate = RATE;
+    b.samples = g.samples();
+    b.length = int(b.samples.size());
+    channel_decoder::remove_avgf(b.samples.data(), b.samples.data(), b.length);
+    return b;
+}
+
+std::vector<float> noise(size_t n, float sigma)
+{
+    std::mt19937 rng(1);
+    std::normal_distribution<float> normal(0.0f, sigma);
+    std::vector<float> s(n);
+    for (float& x : s) {
+        x = normal(rng);
+    }
+    return s;
+}
+
+// ----------------------------------------------------------------------------
+// Tone correlators: acars_dec() filters the burst with two bits of each tone
+// ----------------------------------------------------------------------------
+// The way acars_dec() does it: products of FFTs of the burst length, with a
+// 3.5 kHz brick-wall low-pass, and back
+struct fft_correlator {
+    int N;
+    fft_plan f2400, f1200, fsig, r1200, r2400;
+
+    explicit fft_correlator(int n)
+        : N(n), f2400(n, true), f1200(n, true), fsig(n, true), r1200(n, false), r2400(n, false)
+    {
+    }
+
+    void run(const float* d)
+    {
+        const int ntone = 2 * RATE / 2400;
+        gr_complex* c2400 = f2400.in();
+        gr_complex* c1200 = f1200.in();
+        for (int t = 0; t < ntone; t++) {
+            c2400[t] = std::polar(1.0f, float(2 * M_PI * 2400.0 / RATE * t));
+            c1200[t] = std::polar(1.0f, float(2 * M_PI * 1200.0 / RATE * t));
+        }
+        std::fill(c2400 + ntone, c2400 + N, gr_complex(0.0f, 0.0f));
+        std::fill(c1200 + ntone, c1200 + N, gr_complex(0.0f, 0.0f));
+        gr_complex* sig = fsig.in();
+        for (int t = 0; t < N; t++) {
+            sig[t] = gr_complex(d[t], 0.0f);
+        }
+        f2400.execute();
+        f1200.execute();
+        fsig.execute();
+        const int kcut = int(float(N) * 3500.0f / float(RATE));
+        gr_complex* a = r2400.in();
+        gr_complex* b = r1200.in();
+        for (int k = 0; k < N; k++) {
+            bool pass = (k < kcut) || (k >= N - kcut);
+            a[k] = pass ? f2400.out()[k] * fsig.out()[k] / float(N) : gr_complex(0.0f, 0.0f);
+            b[k] = pass ? f1200.out()[k] * fsig.out()[k] / float(N) : gr_complex(0.0f, 0.0f);
+        }
+        r2400.execute();
+        r1200.execute();
+    }
+};
+
+// Direct convolution with the two-bit tones: 2 x 40 products per sample
+void direct_correlate(const float* d, int N, gr_complex* c1200, gr_complex* c2400)
+{
+    const int ntone = 2 * RATE / 2400;
+    gr_complex t1200[2 * RATE / 2400];
+    gr_complex t2400[2 * RATE / 2400];
+    for (int t = 0; t < ntone; t++) {
+        t2400[t] = std::polar(1.0f, float(2 * M_PI * 2400.0 / RATE * t));
+        t1200[t] = std::polar(1.0f, float(2 * M_PI * 1200.0 / RATE * t));
+    }
+    for (int k = 0; k < N; k++) {
+        gr_complex a(0.0f, 0.0f);
+        gr_complex b(0.0f, 0.0f);
+        for (int t = 0; (t < ntone) && (t <= k); t++) {
+            a += t2400[t] * d[k - t];
+            b += t1200[t] * d[k - t];
+        }
+        c2400[k] = a;
+        c1200[k] = b;
+    }
+}
+
+// Sliding DFT: the same magnitudes from a running sum of the demodulated
+// samples over two bits, a few operations per sample
+void sliding_correlate(const float* d, int N, gr_complex* c1200, gr_complex* c2400)
+{
+    const int ntone = 2 * RATE / 2400;
+    // the tones have a whole number of periods over the window at 48 kHz
+    gr_complex w2400[2 * RATE / 2400];
+    gr_complex w1200[2 * RATE / 2400];
+    for (int t = 0; t < ntone; t++) {
+        w2400[t] = std::polar(1.0f, float(-2 * M_PI * 2400.0 / RATE * t));
+        w1200[t] = std::polar(1.0f, float(-2 * M_PI * 1200.0 / RATE * t));
+    }
+    gr_complex a(0.0f, 0.0f);
+    gr_complex b(0.0f, 0.0f);
+    for (int k = 0, p = 0; k < N; k++, p = (p + 1 == ntone) ? 0 : p + 1) {
+        float old = (k >= ntone) ? d[k - ntone] : 0.0f;
+        a += w2400[p] * (d[k] - old);
+        b += w1200[p] * (d[k] - old);
+        c2400[k] = a;
+        c1200[k] = b;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// JSON output
+// ----------------------------------------------------------------------------
+void write_json(const char* path)
+{
+    FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::perror(path);
+        std::exit(1);
+    }
+    char date[64];
+    time_t now = time(nullptr);
+    struct tm tmv;
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime_r(&now, &tmv));
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+
+    std::fprintf(f,
+                 "{\n  \"context\": {\n"
+                 "    \"date\": \"%s\",\n"
+                 "    \"host_name\": \"%s\",\n"
+                 "    \"executable\": \"bench_acars_stages\",\n"
+                 "    \"num_cpus\": %u,\n"
+                 "    \"sample_rate\": %d\n"
+                 "  },\n  \"benchmarks\": [\n",
+                 date, host, std::thread::hardware_concurrency(), RATE);
+    for (size_t k = 0; k < results.size(); k++) {
+        const result& r = results[k];
+        std::fprintf(f,
+                     "    {\n"
+                     "      \"name\": \"%s\",\n"
+                     "      \"run_type\": \"iteration\",\n"
+                     "      \"iterations\": %lu,\n"
+                     "      \"real_time\": %.3f,\n"
+                     "      \"cpu_time\": %.3f,\n"
+                     "      \"time_unit\": \"ns\",\n"
+                     "      \"unit\": \"%s\",\n"
+                     "      \"units_per_iteration\": %.1f,\n"
+                     "      \"ns_per_unit\": %.4f\n"
+                     "    }%s\n",
+                     r.name.c_str(), (unsigned long)r.iterations, r.ns, r.ns,
+                     r.unit.c_str(), r.units, r.ns / r.units,
+                     (k + 1 < results.size()) ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const char* json = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:t:f:")) != -1) {
+        switch (opt) {
+        case 'j':
+            json = optarg;
+            break;
+        case 't':
+            min_time = std::atof(optarg);
+            break;
+        case 'f':
+            filter = optarg;
+            break;
+        default:
+            std::fprintf(stderr,
+                         "usage: %s [-j file.json] [-t seconds per batch] [-f filter]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    // --- detector ---------------------------------------------------------
+    {
+        const int chunk = channel_decoder::CHUNK;
+        std::vector<float> in = noise(64 * chunk, 0.05f);
+        std::vector<float> out(chunk);
+        bench("remove_avgf", "sample", chunk, [&] {
+            channel_decoder::remove_avgf(in.data(), out.data(), chunk);
+        });
+
+        // noise only: a chunk through the detector, no burst
+        message_output null_out("", 0, 0, 0.0f, "", 0.0f, 0.0f, "bench", false);
+        decode_pool pool(0, 16);
+        channel_decoder det(3.0f, RATE, &null_out, nullptr, &pool);
+        std::vector<int16_t> s16(in.size());
+        std::vector<int8_t> s8(in.size());
+        for (size_t k = 0; k < in.size(); k++) {
+            s16[k] = int16_t(std::lround(in[k] * 32767));
+            s8[k] = int8_t(std::lround(in[k] * 127));
+        }
+        uint64_t offset = 0;
+        size_t pos = 0;
+        auto next = [&]() {
+            size_t p = pos;
+            pos = (pos + chunk) % in.size();
+            offset += chunk;
+            return p;
+        };
+        bench("detector/float", "sample", chunk, [&] {
+            size_t p = next();
+            det.process(&in[p], chunk, offset);
+        });
+        bench("detector/s16", "sample", chunk, [&] {
+            size_t p = next();
+            det.process(&s16[p], chunk, offset);
+        });
+        bench("detector/s8", "sample", chunk, [&] {
+            size_t p = next();
+            det.process(&s8[p], chunk, offset);
+        });
+    }
+
+    // --- demodulation, for a range of burst lengths -----------------------
+    burst_decoder dec;
+    for (size_t text : { 0, 30, 110, 220 }) {
+        burst b = make_burst(text);
+        std::string name = "acars_dec/text:" + std::to_string(text);
+        bench(name, "sample", b.length, [&] { dec.acars_dec(b, nullptr); });
+    }
+
+    // --- tone correlation, acars_dec() way and alternatives ---------------
+    burst b = make_burst(110);
+    const int N = b.length;
+    const float* d = b.samples.data();
+    {
+        bench("correlate/fft+plans", "sample", N, [&] {
+            fft_correlator c(N);
+            c.run(d);
+        });
+        fft_correlator c(N);
+        bench("correlate/fft", "sample", N, [&] { c.run(d); });
+        std::vector<gr_complex> c1200(N), c2400(N);
+        bench("correlate/direct", "sample", N, [&] {
+            direct_correlate(d, N, c1200.data(), c2400.data());
+        });
+        bench("correlate/sliding_dft", "sample", N, [&] {
+            sliding_correlate(d, N, c1200.data(), c2400.data());
+        });
+    }
+
+    // --- bit slicing, byte assembly, record -------------------------------
+    {
+        fft_correlator c(N);
+        c.run(d);
+        // the magnitudes are taken in place, and again on each call
+        std::vector<gr_complex> c1200(c.r1200.out(), c.r1200.out() + N);
+        std::vector<gr_complex> c2400(c.r2400.out(), c.r2400.out() + N);
+        int nbits = dec.slice(c1200.data(), c2400.data(), N, RATE, b.soft.data());
+        bench("slice", "bit", nbits, [&] {
+            dec.slice(c1200.data(), c2400.data(), N, RATE, b.soft.data());
+        });
+
+        b.nbits = nbits;
+        dec.frame(b);
+        if (!b.bcs_ok) {
+            std::fprintf(stderr, "warning: the benchmark burst does not decode\n");
+        }
+        bench("frame", "message", 1, [&] { dec.frame(b); });
+
+        message_output out("", 0, 0, 0.0f, "", 0.0f, 0.0f, "bench", false);
+        bench("parse", "message", 1, [&] {
+            out.parse(b.message.data(), b.nbytes, "", &b.start);
+        });
+    }
+
+    if (json) {
+        write_json(json);
+    }
+    return 0;
+}
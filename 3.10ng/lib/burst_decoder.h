@@ -0,0 +1,124 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_BURST_DECODER_H
+#define INCLUDED_ACARS_BURST_DECODER_H
+
+#include "burst_dump.h"
+#include "fft_plan.h"
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <time.h>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+class stage_stats;
+
+typedef std::complex<float> gr_complex; ///< as in GNU Radio, without depending on it
+
+/*!
+ * \brief A detected burst on its way through the decoder, then its result.
+ *
+ * Bursts are handed between the detector, the decode threads and the output
+ * stage by std::unique_ptr, and recycled with their buffers.
+ */
+struct burst {
+    int rate;                   ///< sample rate of the channel
+    std::vector<float> samples; ///< detector buffer, mean removed
+    int first;                  ///< first sample of the burst in samples
+    int length;                 ///< samples of the burst
+    uint64_t offset;            ///< stream index of samples[first]
+    struct timespec start;      ///< wall clock time of samples[first]
+    int64_t submitted;          ///< steady clock (ns) when queued for decoding
+    int64_t cpu_ns;             ///< decode thread CPU time of the burst
+
+    std::vector<float> soft;  ///< tone difference per bit, > 0 for 2400 Hz
+    int nbits;                ///< bits in soft
+
+    std::vector<char> message;          ///< decoded 7-bit characters
+    std::vector<unsigned char> octets;  ///< the same with parity, for the BCS
+    int nbytes;                         ///< characters decoded
+    bool bcs_ok;                        ///< the BCS matched
+    burst_record* dump;                 ///< capture slot, or nullptr
+
+    burst();
+};
+
+/*!
+ * \brief Demodulator and slicer: acars_dec() with its scratch buffers.
+ *
+ * The sample rate of each burst is a runtime value. The bit slicer is
+ * instantiated with the samples per bit as a template argument for 12, 24,
+ * 48 and 96 kHz, and with a fractional bit clock for the other rates. It
+ * keeps a soft metric per bit, the normalized difference of the 2400 and
+ * 1200 Hz magnitudes, from which frame() takes the decisions; the diversity
+ * combiner frames the sum of the metrics of several receivers the same way.
+ *
+ * One instance per decoding thread; decode() only touches the burst it is
+ * given and the capture ring, which is locked. Its buffers are sized for the
+ * longest burst at 48 kHz when it is made, and its FFT plans are kept per
+ * transform length, so that it does not allocate once it has seen the
+ * lengths of the bursts.
+ */
+class burst_decoder
+{
+private:
+    //! In-place plans of one transform length
+    struct fft_length {
+        int n;
+        std::unique_ptr<fft_plan> forward;
+        std::unique_ptr<fft_plan> backward;
+    };
+
+    std::vector<char> _toutd; ///< buffer for demod bits
+    std::vector<char> _tout;  ///< buffer for final bits
+    std::vector<fft_length> _ffts; ///< plans of the lengths met so far
+    fft_buffer _corr2400;          ///< 2400 Hz correlator
+    fft_buffer _corr1200;          ///< 1200 Hz correlator
+    fft_buffer _spectrum;          ///< burst spectrum
+
+    const fft_length& plans(int n);
+
+    template <int SPB>
+    int slice_spb(gr_complex* c1200, gr_complex* c2400, int N, double spb, float* soft);
+
+public:
+    burst_decoder();
+
+    //! Decode b, keeping a copy of the burst in \p dump if not nullptr, the
+    //! time of each stage going to \p stats if not nullptr
+    void acars_dec(burst& b, burst_dump* dump, stage_stats* stats = nullptr);
+    /*!
+     * \brief Soft bits from the tone correlator outputs of a burst of \p N
+     * samples at \p rate, returns the bit count. \p c1200 and \p c2400 are
+     * replaced by their magnitudes.
+     */
+    int slice(gr_complex* c1200, gr_complex* c2400, int N, int rate, float* soft);
+    //! Characters and BCS check of b from its soft bits
+    void frame(burst& b);
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_BURST_DECODER_H */
@@ -0,0 +1,268 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "burst_dump.h"
+#include <cstdio>
+#include <ctime>
+
+namespace gr {
+namespace acars {
+
+const char* decode_status_name(decode_status s)
+{
+    switch (s) {
+    case DECODE_OK:
+        return "ok";
+    case DECODE_NO_SYNC:
+        return "no-sync";
+    case DECODE_BAD_CRC:
+        return "bad-crc";
+    }
+    return "unknown";
+}
+
+burst_dump::burst_dump(format fmt,
+                       policy pol,
+                       unsigned sample_every,
+                       double sample_rate,
+                       const std::string& dir,
+                       const std::string& tag,
+                       size_t depth)
+    : _format(fmt),
+      _policy(pol),
+      _sample_every(sample_every),
+      _ok_count(0),
+      _rate(sample_rate),
+      _dir(dir),
+      _tag(tag),
+      _ring(depth > 0 ? depth : 1),
+      _head(0),
+      _dropped(0),
+      _written(0),
+      _running(true)
+{
+    _thread = std::thread(&burst_dump::writer, this);
+}
+
+burst_dump::~burst_dump()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _cond.notify_one();
+    _thread.join(); // pending bursts are written before the thread exits
+}
+
+burst_record* burst_dump::acquire()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    slot& s = _ring[_head];
+    if ((s.state == WRITING) || (s.state == FILLING)) {
+        _dropped++; // still being written, or filled by another decoder
+        return nullptr;
+    }
+    if (s.state == PENDING) {
+        _dropped++; // overwritten before the writer got to it
+    }
+    s.state = FILLING;
+    _head = (_head + 1) % _ring.size();
+    return &s.rec;
+}
+
+void burst_dump::commit(burst_record* b)
+{
+    bool persist = (_policy == CAPTURE_ALL) || (b->status != DECODE_OK);
+    if (!persist && (_sample_every > 0) && (++_ok_count >= _sample_every)) {
+        _ok_count = 0;
+        persist = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& s : _ring) {
+            if (&s.rec == b) {
+                s.state = persist ? PENDING : HISTORY;
+            }
+        }
+    }
+    if (persist) {
+        _cond.notify_one();
+    }
+}
+
+uint64_t burst_dump::dropped()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+}
+
+uint64_t burst_dump::written()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _written;
+}
+
+// oldest PENDING slot, in ring order starting from _head (called locked)
+burst_dump::slot* burst_dump::oldest_pending()
+{
+    for (size_t k = 0; k < _ring.size(); k++) {
+        slot& s = _ring[(_head + k) % _ring.size()];
+        if (s.state == PENDING) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+void burst_dump::writer()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        slot* s;
+        _cond.wait(lock, [this, &s] { return ((s = oldest_pending()) != nullptr) || !_running; });
+        if (!s) {
+            return; // stopped and drained
+        }
+        s->state = WRITING;
+        lock.unlock();
+
+        if (_format == SIGMF) {
+            write_sigmf(s->rec);
+        } else {
+            write_text(s->rec);
+        }
+
+        lock.lock();
+        s->state = HISTORY;
+        _written++;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// write_text(): legacy five-column ASCII dump
+// ----------------------------------------------------------------------------
+void burst_dump::write_text(const burst_record& b)
+{
+    char s[256];
+    struct tm tmv;
+    localtime_r(&b.start.tv_sec, &tmv);
+    std::strftime(s, sizeof(s), "/tmp/%Y%m%d_%H%M%S_acars.dump", &tmv);
+    std::printf("writing file %s\n", s);
+
+    FILE* fil = std::fopen(s, "w+");
+    if (!fil) {
+        std::perror("Failed to open raw dump file");
+        return;
+    }
+    std::fprintf(fil, "%% raw\tRe(1200)\tIm(1200)\tRe(2400)\tIm(2400)\n");
+    for (size_t t = 0; t < b.raw.size(); t++) {
+        std::fprintf(fil, "%f\t%f\t%f\t%f\t%f\n",
+                     b.raw[t],
+                     b.tones[2 * t].real(), b.tones[2 * t].imag(),
+                     b.tones[2 * t + 1].real(), b.tones[2 * t + 1].imag());
+    }
+    std::fclose(fil);
+}
+
+// ----------------------------------------------------------------------------
+// write_sigmf(): raw (rf32_le) and tones (2-channel cf32_le) recordings
+// ----------------------------------------------------------------------------
+static bool write_data(const std::string& path, const void* data, size_t bytes)
+{
+    FILE* fil = std::fopen(path.c_str(), "wbx"); // never overwrite a dump
+    if (!fil) {
+        std::perror(("Failed to open " + path).c_str());
+        return false;
+    }
+    bool ok = (std::fwrite(data, 1, bytes, fil) == bytes);
+    return (std::fclose(fil) == 0) && ok;
+}
+
+bool burst_dump::write_meta(const std::string& base,
+                            const burst_record& b,
+                            const char* datatype,
+                            int channels,
+                            size_t count)
+{
+    FILE* fil = std::fopen((base + ".sigmf-meta").c_str(), "wx");
+    if (!fil) {
+        std::perror(("Failed to open " + base + ".sigmf-meta").c_str());
+        return false;
+    }
+    char datetime[64];
+    struct tm tmv;
+    gmtime_r(&b.start.tv_sec, &tmv);
+    size_t len = std::strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%S", &tmv);
+    std::snprintf(datetime + len, sizeof(datetime) - len, ".%06ldZ",
+                  b.start.tv_nsec / 1000);
+
+    std::fprintf(fil,
+                 "{\n"
+                 "  \"global\": {\n"
+                 "    \"core:datatype\": \"%s\",\n"
+                 "    \"core:sample_rate\": %.1f,\n"
+                 "    \"core:num_channels\": %d,\n"
+                 "    \"core:version\": \"1.0.0\",\n"
+                 "    \"core:recorder\": \"gr-acars\",\n"
+                 "    \"core:description\": \"ACARS burst%s\",\n"
+                 "    \"core:extensions\": [\n"
+                 "      { \"name\": \"acars\", \"version\": \"1.0.0\", \"optional\": true }\n"
+                 "    ]\n"
+                 "  },\n"
+                 "  \"captures\": [\n"
+                 "    {\n"
+                 "      \"core:sample_start\": 0,\n"
+                 "      \"core:global_index\": %llu,\n"
+                 "      \"core:datetime\": \"%s\"\n"
+                 "    }\n"
+                 "  ],\n"
+                 "  \"annotations\": [\n"
+                 "    {\n"
+                 "      \"core:sample_start\": 0,\n"
+                 "      \"core:sample_count\": %zu,\n"
+                 "      \"core:label\": \"%s\",\n"
+                 "      \"acars:bytes\": %d\n"
+                 "    }\n"
+                 "  ]\n"
+                 "}\n",
+                 datatype,
+                 _rate,
+                 channels,
+                 (channels == 2) ? ", channel 0: 1200 Hz, channel 1: 2400 Hz correlator" : "",
+                 (unsigned long long)b.sample_offset,
+                 datetime,
+                 count,
+                 decode_status_name(b.status),
+                 b.nbytes);
+    return std::fclose(fil) == 0;
+}
+
+void burst_dump::write_sigmf(const burst_record& b)
+{
+    char s[64];
+    struct tm tmv;
+    localtime_r(&b.start.tv_sec, &tmv);
+    std::strftime(s, sizeof(s), "%Y%m%d_%H%M%S", &tmv);
+    // the stream offset makes the name unique within an instance, the tag
+    // across instances
+    std::string base = _dir + "/acars" + _tag + "_" + s + "_" +
+                       std::to_string((unsigned long long)b.sample_offset);
+
+    if (write_data(base + "_raw.sigmf-data", b.raw.data(), b.raw.size() * sizeof(float))) {
+        write_meta(base + "_raw", b, "rf32_le", 1, b.raw.size());
+    }
+    if (write_data(base + "_tones.sigmf-data",
+                   b.tones.data(),
+                   b.tones.size() * sizeof(std::complex<float>))) {
+        write_meta(base + "_tones", b, "cf32_le", 2, b.tones.size() / 2);
+    }
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,141 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_BURST_DUMP_H
+#define INCLUDED_ACARS_BURST_DUMP_H
+
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Outcome of acars_dec() on one burst, recorded with the dumps.
+ */
+enum decode_status { DECODE_OK = 0, DECODE_NO_SYNC, DECODE_BAD_CRC };
+
+const char* decode_status_name(decode_status s);
+
+/*!
+ * \brief One burst, as kept in the capture ring.
+ */
+struct burst_record {
+    std::vector<float> raw;                 ///< input samples of the burst
+    std::vector<std::complex<float>> tones; ///< 1200 Hz, 2400 Hz interleaved
+    uint64_t sample_offset;                 ///< index of raw[0] in the stream
+    struct timespec start;                  ///< wall clock time of raw[0]
+    decode_status status;
+    int nbytes;                             ///< bytes assembled by acars_dec()
+};
+
+/*!
+ * \brief Bounded ring of the last bursts, persisted by a background thread.
+ *
+ * acars_dec() fills the next slot of a ring of \p depth preallocated
+ * records (acquire()), then commit()s it with its decode result. The capture
+ * policy decides whether the burst is persisted: CAPTURE_ALL writes every
+ * burst, CAPTURE_FAILED only those failing the sync or BCS check, plus one
+ * successful burst out of \p sample_every (0: none). Disk traffic therefore
+ * scales with failures, not with traffic. Slot buffers keep their capacity,
+ * so memory is bounded by depth times the largest burst and the ring does
+ * not allocate in steady state.
+ *
+ * In text mode, the legacy five-column /tmp/%Y%m%d_%H%M%S_acars.dump files
+ * are produced. In SigMF mode each burst gives two recordings named
+ * <dir>/acars<tag>_<YYYYmmdd_HHMMSS>_<offset>_{raw,tones}: the input samples
+ * as rf32_le, and the two tone correlator outputs as a 2-channel cf32_le
+ * recording, each with a .sigmf-meta holding sample rate, timestamp,
+ * sample offset and decode result.
+ *
+ * Nothing blocks on the writer: a burst still waiting to be written when
+ * its slot comes round again is overwritten and counted as dropped.
+ */
+class burst_dump
+{
+public:
+    enum format { TEXT = 0, SIGMF };
+    enum policy { CAPTURE_ALL = 0, CAPTURE_FAILED };
+
+private:
+    enum slot_state { FREE, FILLING, HISTORY, PENDING, WRITING };
+    struct slot {
+        burst_record rec;
+        slot_state state;
+        slot() : state(FREE) {}
+    };
+
+    format _format;
+    policy _policy;
+    unsigned _sample_every;
+    unsigned _ok_count; ///< successful bursts since the last sampled one
+    double _rate;
+    std::string _dir;
+    std::string _tag;
+
+    std::vector<slot> _ring;
+    size_t _head; ///< next slot to fill, i.e. the oldest one
+    uint64_t _dropped;
+    uint64_t _written;
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _running;
+    std::thread _thread;
+
+    void writer();
+    slot* oldest_pending();
+    void write_text(const burst_record& b);
+    void write_sigmf(const burst_record& b);
+    bool write_meta(const std::string& base,
+                    const burst_record& b,
+                    const char* datatype,
+                    int channels,
+                    size_t count);
+
+public:
+    burst_dump(format fmt,
+               policy pol,
+               unsigned sample_every,
+               double sample_rate,
+               const std::string& dir,
+               const std::string& tag,
+               size_t depth);
+    ~burst_dump();
+
+    //! Next slot to fill, nullptr if the writer or another decoder has it
+    burst_record* acquire();
+    //! Hand back a filled slot; persisted or not according to the policy
+    void commit(burst_record* b);
+
+    uint64_t dropped();
+    uint64_t written();
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_BURST_DUMP_H */
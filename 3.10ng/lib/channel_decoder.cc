@@ -0,0 +1,337 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#undef jmfdebug
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "diversity_combiner.h"
+#include "fixed_point.h"
+#include "trace_buffer.h"
+#include <volk/volk.h>
+#include <bitset>
+#include <cmath>    // for std::sqrt, std::abs
+#include <cstdio>
+#include <time.h>
+
+#define MESSAGE    (220 * 2)     // 2 x max message size
+
+namespace gr {
+namespace acars {
+
+// ----------------------------------------------------------------------------
+// Constructor
+// ----------------------------------------------------------------------------
+channel_decoder::channel_decoder(float seuil,
+                                 int rate,
+                                 message_output* out,
+                                 burst_dump* dump,
+                                 decode_pool* pool,
+                                 const std::string& label)
+    : _seuil(seuil)
+    , _rate(rate)
+    , _chunk(int(std::lround(double(CHUNK) * rate / RATE)))
+    // 48k/2400=20 sym/bit => 8 bits*440 char=70400
+    , _maxsize(int(std::lround(MESSAGE * 8 * (rate / 2400.0))))
+    , _Ntot(0)
+    , _threshold(0.0f)
+    , _decompte(0)
+    , _out(out)
+    , _dump(dump)
+    , _pool(pool)
+    , _label(label)
+    , _combiner(nullptr)
+    , _branch(0)
+    , _listener(nullptr)
+    , _stream_time(false)
+    , _console(nullptr)
+    , _t0{ 0, 0 }
+    , _scratch(_chunk)
+    , _seq_in(0)
+    , _seq_out(0)
+    , _done(64)
+{
+    next_burst();
+    trace_from_environment();
+}
+
+// A burst buffer from the pool, with room for the longest burst
+void channel_decoder::next_burst()
+{
+    _cur = _pool->get();
+    _cur->samples.reserve(_maxsize);
+}
+
+// ----------------------------------------------------------------------------
+// process(): burst detection on one chunk of input samples
+// ----------------------------------------------------------------------------
+void channel_decoder::process(const float* in, int n, uint64_t offset)
+{
+    stage_timer t(&_stats, STAGE_DETECT);
+    if (n > int(_scratch.size())) {
+        _scratch.resize(n); // not with chunks of chunk() samples
+    }
+    _detected.samples.add(n);
+    if (detect(remove_avgf(in, _scratch.data(), n), n, offset)) {
+        // Accumulate data in the burst buffer
+        _cur->samples.insert(_cur->samples.end(), in, in + n);
+    }
+}
+
+// Integer input: the detector works on exact integer sums, and only the
+// chunks of a burst are converted to float (full scale is 1.0) for decoding
+void channel_decoder::process(const int16_t* in, int n, uint64_t offset)
+{
+    stage_timer t(&_stats, STAGE_DETECT);
+    _detected.samples.add(n);
+    if (detect(stats_stddev(stats_s16(in, n), n, 1.0f / 32768), n, offset)) {
+        std::vector<float>& d = _cur->samples;
+        size_t m = d.size();
+        d.resize(m + n);
+        volk_16i_s32f_convert_32f(&d[m], in, 32768.0f, n);
+    }
+}
+
+void channel_decoder::process(const int8_t* in, int n, uint64_t offset)
+{
+    stage_timer t(&_stats, STAGE_DETECT);
+    _detected.samples.add(n);
+    if (detect(stats_stddev(stats_s8(in, n), n, 1.0f / 128), n, offset)) {
+        std::vector<float>& d = _cur->samples;
+        size_t m = d.size();
+        d.resize(m + n);
+        volk_8i_s32f_convert_32f(&d[m], in, 128.0f, n);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// detect(): threshold logic, true if the chunk is to be added to the burst
+// ----------------------------------------------------------------------------
+bool channel_decoder::detect(float stddev, int n, uint64_t offset)
+{
+    // If we haven't set an initial threshold, set it.
+    if (_threshold == 0.0f) {
+        _threshold = stddev;
+    }
+
+    // If we detect a signal above threshold OR we are still counting down _decompte
+    if ((stddev > (_seuil * _threshold)) || (_decompte > 0)) {
+        if (_Ntot == 0) {
+            // first chunk of a burst: remember where it is in the stream
+            _cur->rate = _rate;
+            _cur->offset = offset;
+            if (_stream_time) {
+                long ns = _t0.tv_nsec + long((offset % _rate) * 1000000000ULL / _rate);
+                _cur->start.tv_sec = _t0.tv_sec + time_t(offset / _rate) + ns / 1000000000L;
+                _cur->start.tv_nsec = ns % 1000000000L;
+            } else {
+                clock_gettime(CLOCK_REALTIME, &_cur->start);
+            }
+        }
+        // Only do three chunks?
+        _decompte++;
+        if (_decompte == 3) {
+            _decompte = 0;
+        }
+        if (_Ntot + n <= _maxsize) {
+            _Ntot += n;
+            return true;
+        }
+        return false;
+    }
+
+    // No signal: if we had some data, decode it
+    _threshold = stddev; // update running threshold
+    _detected.noise.store(stddev, std::memory_order_relaxed);
+    if (_Ntot > 0) {
+        if (_console) {
+            std::fprintf(_console, "threshold: %f processing length: %d ", _threshold, _Ntot);
+        }
+        std::vector<float>& _d = _cur->samples;
+        remove_avgf(_d.data(), _d.data(), _Ntot);
+        int pos_start = 0;
+        while ((pos_start < _Ntot) && (_d[pos_start] < (_seuil * _threshold))) {
+            pos_start++;
+        }
+#ifdef jmfdebug
+        std::printf("start: %d, ", pos_start);
+        std::fflush(stdout);
+#endif
+        int pos_end = _Ntot - 1;
+        while ((pos_end > 0) && (_d[pos_end] < (_seuil * _threshold))) {
+            pos_end--;
+        }
+#ifdef jmfdebug
+        std::printf("end: %d\n", pos_end);
+        std::fflush(stdout);
+#endif
+        if ((pos_end > pos_start) && ((pos_end - pos_start) > 200)) {
+            _cur->first = pos_start;
+            _cur->length = pos_end - pos_start;
+            _cur->offset += pos_start;
+            long ns = _cur->start.tv_nsec + long(pos_start * (1e9 / _rate));
+            _cur->start.tv_sec += ns / 1000000000L;
+            _cur->start.tv_nsec = ns % 1000000000L;
+            _cur->submitted = stage_clock();
+            _detected.bursts.add(1);
+            _detected.burst_samples.add(uint64_t(_cur->length));
+            // decoded on a pool thread; work() goes on with the samples
+            if (_pool->submit(this, _seq_in, std::move(_cur))) {
+                _seq_in++;
+            }
+            next_burst();
+        } else {
+            if (_console) {
+                std::fprintf(_console, "Error: pos_end<pos_start: %d vs %d\n", pos_end,
+                             pos_start);
+            }
+            _cur->samples.clear();
+        }
+        _Ntot = 0; // reset
+    }
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// remove_avgf(): subtract mean from samples, return standard deviation
+// ----------------------------------------------------------------------------
+float channel_decoder::remove_avgf(const float *d, float *out, int tot_len)
+{
+    float avg = 0.0f;
+    float var = 0.0f;
+    for (int k = 0; k < tot_len; k++) {
+        avg += d[k];
+    }
+    avg /= static_cast<float>(tot_len);
+
+    for (int k = 0; k < tot_len; k++) {
+        out[k] = d[k] - avg;
+        var += out[k] * out[k];
+    }
+    // Return std dev
+    return std::sqrt(var / static_cast<float>(tot_len));
+}
+
+// ----------------------------------------------------------------------------
+// decode(): demodulation on a decode thread
+// ----------------------------------------------------------------------------
+void channel_decoder::decode(burst_decoder& dec, burst& b)
+{
+#ifdef ACARS_STAGE_TIMING
+    _stats.record(STAGE_QUEUE, stage_clock() - b.submitted);
+#endif
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+    dec.acars_dec(b, _dump, &_stats);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+    b.cpu_ns = int64_t(t1.tv_sec - t0.tv_sec) * 1000000000 + (t1.tv_nsec - t0.tv_nsec);
+}
+
+// ----------------------------------------------------------------------------
+// complete(): in-order output of the decoded bursts
+// ----------------------------------------------------------------------------
+void channel_decoder::complete(uint64_t seq, std::unique_ptr<burst> b, decode_pool& pool)
+{
+    uint64_t out = _seq_out.load();
+    if (seq - out >= _done.size()) {
+        // more bursts in flight than ever: a larger ring, same slots mod size
+        std::vector<std::unique_ptr<burst>> done(2 * (seq - out + 1));
+        for (uint64_t s = out; s < out + _done.size(); s++) {
+            done[s % done.size()] = std::move(_done[s % _done.size()]);
+        }
+        _done.swap(done);
+    }
+    _done[seq % _done.size()] = std::move(b);
+    for (std::unique_ptr<burst>* p = &_done[out % _done.size()]; *p;
+         p = &_done[out % _done.size()]) {
+        output(**p);
+        pool.release(std::move(*p));
+        _seq_out.store(++out);
+    }
+}
+
+// The console dump of a burst: the time, the first characters and their
+// parity checks in hex, then the printable characters
+void channel_decoder::print_burst(const burst& b)
+{
+    time_t tm;
+    time(&tm);
+    char s[64];
+    struct tm tmv;
+    localtime_r(&tm, &tmv); // the pools of several blocks output concurrently
+    std::strftime(s, sizeof(s), "%c", &tmv);
+    std::fprintf(_console, "\n%s\n", s);
+
+    int check_len = (b.nbytes > 10) ? 10 : b.nbytes;
+    for (int i = 0; i < check_len; i++) {
+        std::fprintf(_console, "%02x ", (unsigned char)b.message[i]);
+    }
+    std::fprintf(_console, "\n");
+    for (int i = 0; i < check_len; i++) {
+        // 1 when the parity of the character is even, i.e. wrong
+        std::fprintf(_console, "%02x ",
+                     unsigned(1 - std::bitset<8>(b.octets[i]).count()) & 0x01);
+    }
+    std::fprintf(_console, "\n");
+
+    for (int i = 0; i < b.nbytes; i++) {
+        char c = b.message[i];
+        if (c >= 32 || c == 13 || c == 10) {
+            std::fputc(c, _console);
+        }
+    }
+    std::fprintf(_console, "\n");
+    std::fflush(_console);
+}
+
+void channel_decoder::output(burst& b)
+{
+    stage_timer t(&_stats, STAGE_OUTPUT);
+    if (_console) {
+        print_burst(b);
+    }
+    decode_status status;
+    if (_combiner) {
+        // one message per transmission, from the copies of all the branches
+        status = !message_output::synced(b.message.data(), b.nbytes)
+                     ? DECODE_NO_SYNC
+                     : (b.bcs_ok ? DECODE_OK : DECODE_BAD_CRC);
+        _combiner->add(_branch, b, _stream_time ? &b.start : nullptr);
+    } else {
+        // parse
+        status = _out->parse(b.message.data(), b.nbytes, _label,
+                             _stream_time ? &b.start : nullptr);
+        if ((status == DECODE_OK) && !b.bcs_ok) {
+            status = DECODE_BAD_CRC;
+        }
+    }
+#ifdef ACARS_STAGE_TIMING
+    _stats.record(STAGE_LATENCY, stage_clock() - b.submitted);
+#endif
+    _output.decoded.add(1);
+    _output.cpu_ns.add(uint64_t(b.cpu_ns));
+    if (status == DECODE_NO_SYNC) {
+        _output.no_sync.add(1);
+    } else if (status == DECODE_BAD_CRC) {
+        _output.bad_crc.add(1);
+    }
+    if (_listener) {
+        static const std::string none;
+        _listener->decoded(b, status, _combiner ? none : _out->record());
+    }
+
+    if (b.dump) {
+        b.dump->status = status;
+        b.dump->nbytes = b.nbytes;
+        _dump->commit(b.dump);
+    }
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,166 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_CHANNEL_DECODER_H
+#define INCLUDED_ACARS_CHANNEL_DECODER_H
+
+#include "burst_decoder.h"
+#include "burst_dump.h"
+#include "channel_stats.h"
+#include "message_output.h"
+#include "stage_stats.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+class decode_pool;
+class diversity_combiner;
+
+/*!
+ * \brief Told of every burst a channel has output, in order, with its
+ * status and the record that went to the log (empty if none). Called with
+ * the output lock of the pool held.
+ */
+class burst_listener
+{
+public:
+    virtual ~burst_listener() {}
+    virtual void decoded(const burst& b, decode_status status, const std::string& record) = 0;
+};
+
+/*!
+ * \brief Burst detector of one AM-demodulated channel.
+ *
+ * process() is fed consecutive chunks of chunk() samples of the channel: chunks whose standard
+ * deviation exceeds seuil times the running noise level are accumulated, and
+ * the burst is moved to the decode pool once the channel is quiet again.
+ * Decoded bursts come back through complete(), possibly out of order when
+ * the pool has several threads; they are output in detection order, the
+ * frames to the shared output stage, the bursts to the optional capture ring.
+ */
+class channel_decoder
+{
+public:
+    static const int RATE = 48000; ///< default sample rate of the channel
+    static const int CHUNK = 1024; ///< samples per process() call at RATE
+
+private:
+    float _seuil;       ///< user threshold multiplier
+    int   _rate;        ///< sample rate of the channel
+    int   _chunk;       ///< samples per process() call, CHUNK scaled to _rate
+    int   _maxsize;     ///< longest burst, in samples
+    int   _Ntot;        ///< total number of samples accumulated
+    float _threshold;   ///< running threshold
+    int   _decompte;    ///< accumulate extra chunks if needed
+    message_output* _out; ///< output stage of the block
+    burst_dump* _dump;    ///< raw capture ring if saveall, else nullptr
+    decode_pool* _pool;   ///< where the bursts are decoded
+    std::string _label;   ///< channel name in the records, may be empty
+    diversity_combiner* _combiner; ///< takes the bursts instead of _out
+    int _branch;                   ///< index of the channel in _combiner
+    burst_listener* _listener;     ///< also told of the output bursts
+    bool _stream_time;             ///< bursts dated from their offset
+    FILE* _console;                ///< where the bursts are printed, or nullptr
+    struct timespec _t0;           ///< time of stream index 0 if _stream_time
+
+    std::vector<float> _scratch;  ///< detector output of a chunk
+    std::unique_ptr<burst> _cur;  ///< burst being accumulated
+    uint64_t _seq_in;             ///< bursts submitted to the pool
+    std::atomic<uint64_t> _seq_out; ///< next burst to output
+    //! decoded, waiting for the previous ones: burst seq in seq % size
+    std::vector<std::unique_ptr<burst>> _done;
+    stage_stats _stats;           ///< latency of the stages of the channel
+    detector_counters _detected;  ///< written by the detector thread
+    char _pad[64];                ///< not on the cache line of _detected
+    output_counters _output;      ///< written under the output lock
+
+    bool detect(float stddev, int n, uint64_t offset);
+    void next_burst();
+    void print_burst(const burst& b);
+    void output(burst& b);
+
+public:
+    channel_decoder(float seuil,
+                    int rate,
+                    message_output* out,
+                    burst_dump* dump,
+                    decode_pool* pool,
+                    const std::string& label = "");
+
+    //! Subtract the mean of the \p n samples of \p d into \p out, returns
+    //! their standard deviation
+    static float remove_avgf(const float* d, float* out, int n);
+
+    void set_seuil(float seuil) { _seuil = seuil; }
+    int chunk() const { return _chunk; }
+
+    //! Give the decoded bursts to \p combiner as its \p branch, not to the output
+    void set_combiner(diversity_combiner* combiner, int branch)
+    {
+        _combiner = combiner;
+        _branch = branch;
+    }
+    /*!
+     * \brief Date the bursts from their stream index, index 0 being \p t0,
+     * instead of with the wall clock: for recorded files
+     */
+    void set_start_time(const struct timespec& t0)
+    {
+        _stream_time = true;
+        _t0 = t0;
+    }
+    //! Tell \p listener of the bursts output from now on
+    void set_listener(burst_listener* listener) { _listener = listener; }
+    //! Print the detection, hex dump and text of every burst on \p console
+    //! (stdout for the blocks), nullptr: not at all, the default
+    void set_console(FILE* console) { _console = console; }
+    //! No burst being accumulated nor decoded (detector thread)
+    bool idle() const { return (_Ntot == 0) && (_seq_out.load() == _seq_in); }
+
+    //! Run the detector on \p n samples, the first one at stream index \p offset
+    void process(const float* in, int n, uint64_t offset);
+    //! Same on 16 or 8-bit samples, full scale being 1.0 in float
+    void process(const int16_t* in, int n, uint64_t offset);
+    void process(const int8_t* in, int n, uint64_t offset);
+
+    //! Latency histograms of the detector, the decoding and the output
+    stage_stats& stats() { return _stats; }
+    const stage_stats& stats() const { return _stats; }
+    //! Counters of the detector and of the output, readable from any thread
+    const detector_counters& detected() const { return _detected; }
+    const output_counters& output_counts() const { return _output; }
+
+    //! Demodulate b with dec (decode thread)
+    void decode(burst_decoder& dec, burst& b);
+    //! Output b and the following decoded bursts in order (pool output lock)
+    void complete(uint64_t seq, std::unique_ptr<burst> b, decode_pool& pool);
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_CHANNEL_DECODER_H */
@@ -0,0 +1,78 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_CHANNEL_STATS_H
+#define INCLUDED_ACARS_CHANNEL_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief A counter with one writer at a time, read from any thread.
+ *
+ * The writer adds with a relaxed load and store, not a locked
+ * read-modify-write, so counting costs the hot path a plain add; readers
+ * see some recent value.
+ */
+class stat_counter
+{
+private:
+    std::atomic<uint64_t> _v;
+
+public:
+    stat_counter() : _v(0) {}
+
+    void add(uint64_t n)
+    {
+        _v.store(_v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    uint64_t get() const { return _v.load(std::memory_order_relaxed); }
+};
+
+/*!
+ * \brief Counters of a channel kept by the thread feeding its detector.
+ */
+struct detector_counters {
+    stat_counter samples;       ///< samples through the detector
+    stat_counter bursts;        ///< bursts detected
+    stat_counter burst_samples; ///< samples of the detected bursts
+    std::atomic<float> noise;   ///< standard deviation of the last quiet chunk
+
+    detector_counters() : noise(0.0f) {}
+};
+
+/*!
+ * \brief Counters of a channel kept by its output stage, under the output
+ * lock of the decode pool, whichever thread holds it.
+ */
+struct output_counters {
+    stat_counter decoded; ///< bursts demodulated and output
+    stat_counter no_sync; ///< bursts without the "+*" SYN SYN SOH start
+    stat_counter bad_crc; ///< synced frames failing the BCS
+    stat_counter cpu_ns;  ///< decode thread CPU time of the bursts
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_CHANNEL_STATS_H */
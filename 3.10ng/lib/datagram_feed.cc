@@ -0,0 +1,188 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "datagram_feed.h"
+#include <netdb.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace gr {
+namespace acars {
+
+datagram_feed::datagram_feed(const std::string& destination, float flush_interval)
+    : _fd(-1),
+      _addrlen(0),
+      _interval(flush_interval > 0.0f ? long(flush_interval * 1e6f) : 0),
+      _active(0),
+      _sent(0),
+      _dropped(0),
+      _running(true)
+{
+    std::memset(&_addr, 0, sizeof(_addr));
+    if (destination.compare(0, 5, "unix:") == 0) {
+        std::string path = destination.substr(5);
+        struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&_addr);
+        if (path.empty() || (path.size() >= sizeof(un->sun_path))) {
+            throw std::invalid_argument("acars: bad unix socket path in feed " +
+                                        destination);
+        }
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+        _addrlen = sizeof(struct sockaddr_un);
+    } else if (destination.compare(0, 4, "udp:") == 0) {
+        std::string hostport = destination.substr(4);
+        size_t colon = hostport.rfind(':');
+        if ((colon == std::string::npos) || (colon == 0)) {
+            throw std::invalid_argument("acars: feed must be udp:<host>:<port>, got " +
+                                        destination);
+        }
+        std::string host = hostport.substr(0, colon);
+        std::string port = hostport.substr(colon + 1);
+        if ((host.front() == '[') && (host.back() == ']')) {
+            host = host.substr(1, host.size() - 2); // [::1]:5555
+        }
+        struct addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        struct addrinfo* res = nullptr;
+        int err = getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+        if (err != 0) {
+            throw std::invalid_argument("acars: cannot resolve feed " + destination +
+                                        ": " + gai_strerror(err));
+        }
+        std::memcpy(&_addr, res->ai_addr, res->ai_addrlen);
+        _addrlen = res->ai_addrlen;
+        freeaddrinfo(res);
+    } else {
+        throw std::invalid_argument(
+            "acars: feed must be udp:<host>:<port> or unix:<path>, got " + destination);
+    }
+
+    _fd = ::socket(_addr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_fd < 0) {
+        throw std::runtime_error(std::string("acars: feed socket: ") +
+                                 std::strerror(errno));
+    }
+
+    prepare(_batch[0]);
+    prepare(_batch[1]);
+    if (_interval.count() > 0) {
+        _thread = std::thread(&datagram_feed::helper, this);
+    }
+}
+
+datagram_feed::~datagram_feed()
+{
+    if (_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+        }
+        _cond.notify_one();
+        _thread.join();
+    }
+    send(_batch[_active]);
+    ::close(_fd);
+}
+
+// ----------------------------------------------------------------------------
+// prepare(): preallocate the slots and point one mmsghdr at each of them
+// ----------------------------------------------------------------------------
+void datagram_feed::prepare(batch& b)
+{
+    b.data.resize(MAX_BATCH * MAX_RECORD);
+    b.msgs.resize(MAX_BATCH);
+    b.iov.resize(MAX_BATCH);
+    for (int i = 0; i < MAX_BATCH; i++) {
+        b.iov[i].iov_base = &b.data[i * MAX_RECORD];
+        b.iov[i].iov_len = 0;
+        std::memset(&b.msgs[i], 0, sizeof(b.msgs[i]));
+        b.msgs[i].msg_hdr.msg_name = &_addr;
+        b.msgs[i].msg_hdr.msg_namelen = _addrlen;
+        b.msgs[i].msg_hdr.msg_iov = &b.iov[i];
+        b.msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    b.count = 0;
+}
+
+void datagram_feed::send(batch& b)
+{
+    int off = 0;
+    while (off < b.count) {
+        int n = ::sendmmsg(_fd, &b.msgs[off], b.count - off, MSG_DONTWAIT);
+        if (n > 0) {
+            _sent.fetch_add(n, std::memory_order_relaxed);
+            off += n;
+        } else if (errno == EINTR) {
+            continue;
+        } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            // socket buffer full: the aggregator is not keeping up
+            _dropped.fetch_add(b.count - off, std::memory_order_relaxed);
+            break;
+        } else {
+            // this datagram was refused (no listener...), go on with the next
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            off++;
+        }
+    }
+    b.count = 0;
+}
+
+void datagram_feed::write(const char* buf, size_t len)
+{
+    if (len > MAX_RECORD) {
+        len = MAX_RECORD;
+    }
+    std::unique_lock<std::mutex> lock(_mutex);
+    batch& b = _batch[_active];
+    if (b.count == MAX_BATCH) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::memcpy(b.iov[b.count].iov_base, buf, len);
+    b.iov[b.count].iov_len = len;
+    b.count++;
+    if (_interval.count() == 0) {
+        send(b); // no batching requested
+    } else if ((b.count == 1) || (b.count == MAX_BATCH)) {
+        // the first record starts the flush interval, a full batch ends it
+        lock.unlock();
+        _cond.notify_one();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// helper(): swap batches and send the full one, a flush interval after the
+// first record, asleep while there is none
+// ----------------------------------------------------------------------------
+void datagram_feed::helper()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        _cond.wait(lock, [this] { return !_running || (_batch[_active].count > 0); });
+        _cond.wait_for(lock, _interval, [this] {
+            return !_running || (_batch[_active].count == MAX_BATCH);
+        });
+        if (_batch[_active].count == 0) {
+            continue;
+        }
+        batch& b = _batch[_active];
+        _active ^= 1; // write() goes on in the other, already sent, batch
+        lock.unlock();
+        send(b);
+        lock.lock();
+    }
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,97 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_DATAGRAM_FEED_H
+#define INCLUDED_ACARS_DATAGRAM_FEED_H
+
+#include "log_sink.h"
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Sends the message records as datagrams to a local aggregator.
+ *
+ * \p destination is either "udp:<host>:<port>" or "unix:<path>" (AF_UNIX
+ * datagram socket). write() only copies the record into a preallocated batch
+ * of MAX_BATCH slots; a helper thread sends the batch with one sendmmsg()
+ * call \p flush_interval seconds after its first record, or as soon as it
+ * is full, and sleeps while no record comes. With a flush interval of 0,
+ * every record is sent from the caller's thread.
+ *
+ * The socket is non-blocking and nothing is retried: records that do not fit
+ * in the batch, are refused by the kernel or find no listener are counted as
+ * dropped. Records longer than MAX_RECORD bytes are truncated.
+ */
+class datagram_feed : public log_sink
+{
+public:
+    static const int MAX_BATCH = 64;
+    static const int MAX_RECORD = 2048;
+
+private:
+    struct batch {
+        std::vector<char> data;       ///< MAX_BATCH slots of MAX_RECORD bytes
+        std::vector<struct mmsghdr> msgs;
+        std::vector<struct iovec> iov;
+        int count;
+    };
+
+    int _fd;
+    struct sockaddr_storage _addr;
+    socklen_t _addrlen;
+    std::chrono::microseconds _interval;
+
+    batch _batch[2];
+    int _active; ///< batch filled by write(), the other one is being sent
+    std::atomic<uint64_t> _sent;
+    std::atomic<uint64_t> _dropped;
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _running;
+    std::thread _thread;
+
+    void prepare(batch& b);
+    void send(batch& b);
+    void helper();
+
+public:
+    datagram_feed(const std::string& destination, float flush_interval);
+    ~datagram_feed() override;
+
+    void write(const char* buf, size_t len) override;
+
+    uint64_t sent() const { return _sent.load(std::memory_order_relaxed); }
+    uint64_t dropped() const override { return _dropped.load(std::memory_order_relaxed); }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_DATAGRAM_FEED_H */
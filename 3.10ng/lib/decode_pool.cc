@@ -0,0 +1,139 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "decode_pool.h"
+#include "channel_decoder.h"
+
+namespace gr {
+namespace acars {
+
+decode_pool::decode_pool(int threads, int depth)
+    : _depth(depth > 0 ? depth : 1),
+      _queued(0),
+      _inflight(0),
+      _max_queued(0),
+      _decoded(0),
+      _dropped(0)
+{
+    if (threads == 0) {
+        _inline.reset(new burst_decoder());
+    } else {
+        _exec = executor::get(threads);
+    }
+}
+
+decode_pool::~decode_pool()
+{
+    // the executor may outlive us: wait for our jobs, they use the channels
+    wait();
+}
+
+void decode_pool::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _inflight == 0; });
+}
+
+std::unique_ptr<burst> decode_pool::get()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_free.empty()) {
+            std::unique_ptr<burst> b = std::move(_free.back());
+            _free.pop_back();
+            return b;
+        }
+    }
+    std::unique_ptr<burst> b(new burst());
+    b->samples.reserve(channel_decoder::RATE); // a typical burst, 1 s at most
+    return b;
+}
+
+void decode_pool::release(std::unique_ptr<burst> b)
+{
+    b->samples.clear();
+    b->dump = nullptr;
+    std::lock_guard<std::mutex> lock(_mutex);
+    _free.push_back(std::move(b));
+}
+
+bool decode_pool::submit(channel_decoder* channel, uint64_t seq, std::unique_ptr<burst> b)
+{
+    if (_inline) {
+        finish(channel, seq, std::move(b), *_inline);
+        return true;
+    }
+    job* j = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_queued < _depth) {
+            if (_free_jobs.empty()) {
+                _free_jobs.emplace_back(new job());
+            }
+            j = _free_jobs.back().release();
+            _free_jobs.pop_back();
+            int q = _queued.load(std::memory_order_relaxed) + 1;
+            _queued.store(q, std::memory_order_relaxed);
+            _inflight++;
+            if (q > _max_queued) {
+                _max_queued = q;
+            }
+        }
+    }
+    if (!j) {
+        // queue full: the decoders are behind, drop rather than stall work()
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        release(std::move(b));
+        return false;
+    }
+    j->pool = this;
+    j->channel = channel;
+    j->seq = seq;
+    j->b = std::move(b);
+    _exec->submit(j);
+    return true;
+}
+
+int decode_pool::max_queued()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _max_queued;
+}
+
+// executor worker: one burst_decoder per worker thread
+void decode_pool::run(job& j)
+{
+    static thread_local burst_decoder dec;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queued.store(_queued.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+    finish(j.channel, j.seq, std::move(j.b), dec);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _free_jobs.emplace_back(&j);
+    if (--_inflight == 0) {
+        _idle.notify_all();
+    }
+}
+
+// decode, then hand the burst back to its channel for in-order output
+void decode_pool::finish(channel_decoder* channel,
+                         uint64_t seq,
+                         std::unique_ptr<burst> b,
+                         burst_decoder& dec)
+{
+    channel->decode(dec, *b);
+    _decoded.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(_out_mutex);
+    channel->complete(seq, std::move(b), *this);
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_DECODE_POOL_H
+#define INCLUDED_ACARS_DECODE_POOL_H
+
+#include "burst_decoder.h"
+#include "executor.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+class channel_decoder;
+
+/*!
+ * \brief Decodes the bursts of the channels of a block on the executor.
+ *
+ * The detector moves each completed burst into submit() and goes on with
+ * the next samples; the burst becomes a job of the executor shared by the
+ * blocks of the process. Up to \p depth bursts of the pool wait for a
+ * worker, further ones are dropped and counted. Each worker thread has its
+ * own burst_decoder. A decoded burst goes back to its channel, which outputs
+ * the bursts in submission order, under a lock shared by the channels of the
+ * pool. With 0 threads, submit() decodes and outputs in the caller's thread.
+ *
+ * Burst buffers and jobs are recycled through the pool, so that a running
+ * pool does not allocate once the buffers have grown to the burst length.
+ */
+class decode_pool
+{
+private:
+    struct job : executor::task {
+        decode_pool* pool;
+        channel_decoder* channel;
+        uint64_t seq;
+        std::unique_ptr<burst> b;
+
+        void run() override { pool->run(*this); }
+    };
+
+    int _depth;
+    std::shared_ptr<executor> _exec;  ///< nullptr when decoding inline
+    std::vector<std::unique_ptr<burst>> _free; ///< recycled bursts
+    std::vector<std::unique_ptr<job>> _free_jobs;
+    std::atomic<int> _queued; ///< jobs waiting for a worker, read without the lock
+    int _inflight;   ///< jobs submitted and not finished
+    int _max_queued;
+    std::mutex _mutex; ///< free lists and counters
+    std::condition_variable _idle;
+
+    std::mutex _out_mutex; ///< serializes the output of the channels
+    std::unique_ptr<burst_decoder> _inline; ///< decoder when there are no threads
+
+    std::atomic<uint64_t> _decoded;
+    std::atomic<uint64_t> _dropped;
+
+    void run(job& j);
+    void finish(channel_decoder* channel,
+                uint64_t seq,
+                std::unique_ptr<burst> b,
+                burst_decoder& dec);
+
+public:
+    /*!
+     * \param threads workers of the shared executor (< 0: one per core,
+     *        0: decode in the caller's thread)
+     * \param depth bursts of this pool waiting for a worker
+     */
+    decode_pool(int threads, int depth);
+    ~decode_pool(); ///< waits for the bursts of the pool to be output
+
+    //! Wait until all the submitted bursts have been output
+    void wait();
+
+    //! An empty burst, recycled if possible
+    std::unique_ptr<burst> get();
+    //! Give a burst back for reuse
+    void release(std::unique_ptr<burst> b);
+    //! Queue b, sequence number seq of its channel; false if dropped
+    bool submit(channel_decoder* channel, uint64_t seq, std::unique_ptr<burst> b);
+
+    int queued() const { return _queued.load(std::memory_order_relaxed); }
+    int max_queued();
+    uint64_t decoded() const { return _decoded.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_DECODE_POOL_H */
@@ -0,0 +1,101 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "dedup_cache.h"
+#include <cstdio>
+#include <map>
+
+namespace gr {
+namespace acars {
+
+dedup_cache::dedup_cache(float window, int capacity)
+    : _window_ns(int64_t(double(window) * 1e9)), _lookups(0), _hits(0)
+{
+    size_t size = 64;
+    while (size < size_t(capacity)) {
+        size <<= 1;
+    }
+    _table.assign(size, entry{ 0, 0 });
+    _mask = size - 1;
+}
+
+std::shared_ptr<dedup_cache> dedup_cache::get(const std::string& name, float window)
+{
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::weak_ptr<dedup_cache>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::shared_ptr<dedup_cache> cache = registry[name].lock();
+    if (!cache) {
+        cache = std::make_shared<dedup_cache>(window);
+        registry[name] = cache;
+    } else if (int64_t(double(window) * 1e9) != cache->_window_ns) {
+        std::printf("dedup group %s: keeping the window of its first block, %f s\n",
+                    name.c_str(), cache->_window_ns * 1e-9);
+    }
+    return cache;
+}
+
+uint64_t dedup_cache::fingerprint(const char* p, int len, uint64_t h)
+{
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char)p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+bool dedup_cache::seen(uint64_t fp, int64_t now_ns)
+{
+    if (fp == 0) {
+        fp = 1; // 0 marks empty slots
+    }
+    _lookups.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    entry* reuse = nullptr;  // first empty or expired slot on the probe path
+    entry* oldest = nullptr; // fallback when every probed slot is live
+    for (int k = 0; k < MAX_PROBE; k++) {
+        entry& e = _table[(fp + k) & _mask];
+        if (e.fp == 0) {
+            if (!reuse) {
+                reuse = &e;
+            }
+            break; // nothing beyond an empty slot
+        }
+        bool expired = (now_ns - e.first_ns) > _window_ns;
+        if (e.fp == fp) {
+            if (!expired) {
+                _hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            reuse = &e; // same message again after the window
+            break;
+        }
+        if (expired && !reuse) {
+            reuse = &e;
+        }
+        if (!oldest || (e.first_ns < oldest->first_ns)) {
+            oldest = &e;
+        }
+    }
+    entry* e = reuse ? reuse : oldest;
+    e->fp = fp;
+    e->first_ns = now_ns;
+    return false;
+}
+
+double dedup_cache::hit_rate() const
+{
+    uint64_t n = lookups();
+    return (n > 0) ? double(hits()) / double(n) : 0.0;
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,84 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_DEDUP_CACHE_H
+#define INCLUDED_ACARS_DEDUP_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Suppresses messages already output within a time window.
+ *
+ * Messages are identified by a 64-bit fingerprint of registration, label,
+ * block id, sequence number and text, kept with the time they were first
+ * seen in an open-addressing table (linear probing). Entries older than the
+ * window are expired lazily: they are reused in place by later insertions.
+ * Probing is bounded, so a lookup is O(1); when all probed slots are live,
+ * the oldest of them is evicted.
+ *
+ * Instances are shared by name through get(), so that all the acars blocks
+ * of a flowgraph (several channels or receivers) use the same cache.
+ */
+class dedup_cache
+{
+private:
+    struct entry {
+        uint64_t fp;      ///< fingerprint, 0 for an empty slot
+        int64_t first_ns; ///< steady clock time of the first sighting
+    };
+
+    static const int MAX_PROBE = 32;
+
+    std::vector<entry> _table;
+    uint64_t _mask;
+    int64_t _window_ns;
+    std::mutex _mutex;
+    std::atomic<uint64_t> _lookups;
+    std::atomic<uint64_t> _hits;
+
+public:
+    dedup_cache(float window, int capacity = 4096);
+
+    //! Shared cache of this name, created with the given window if needed
+    static std::shared_ptr<dedup_cache> get(const std::string& name, float window);
+
+    //! FNV-1a, to be chained over the fields of a message
+    static uint64_t fingerprint(const char* p, int len, uint64_t h = 0xcbf29ce484222325ULL);
+
+    //! True if fp was seen less than window seconds before now_ns
+    bool seen(uint64_t fp, int64_t now_ns);
+
+    uint64_t lookups() const { return _lookups.load(std::memory_order_relaxed); }
+    uint64_t hits() const { return _hits.load(std::memory_order_relaxed); }
+    double hit_rate() const;
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_DEDUP_CACHE_H */
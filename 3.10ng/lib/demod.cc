@@ -0,0 +1,420 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <acars/demod.h>
+#include "am_frontend.h"
+#include "burst_dump.h"
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "message_output.h"
+#include "metrics_server.h"
+#include "stage_stats.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+// ----------------------------------------------------------------------------
+// decimation(): complex input samples per decoder sample
+// ----------------------------------------------------------------------------
+// The decoder runs at 48, 24 or 12 kHz (or 96 kHz) when one of them divides
+// the input rate, so that the fast paths of the slicer are used; otherwise
+// at the input rate divided down to between 48 and 96 kHz.
+static int decimation(double samp_rate)
+{
+    static const double rates[] = { 48000, 24000, 12000, 96000 };
+    for (double r : rates) {
+        double d = samp_rate / r;
+        if ((d >= 1.0) && (std::fabs(d - std::lround(d)) < 1e-9)) {
+            return int(std::lround(d));
+        }
+    }
+    return std::max(1, int(samp_rate / 48000));
+}
+
+static size_t sample_size(demod::input_type input)
+{
+    switch (input) {
+    case demod::INPUT_COMPLEX:
+        return sizeof(std::complex<float>);
+    case demod::INPUT_SHORT:
+        return sizeof(int16_t);
+    case demod::INPUT_CHAR:
+        return sizeof(int8_t);
+    default:
+        return sizeof(float);
+    }
+}
+
+struct demod::impl : public burst_listener {
+    config cfg;
+    int decim; ///< input samples per decoder sample
+    int rate;  ///< decoder rate
+    int chunk; ///< decoder samples per detector call
+
+    // destroyed from the bottom: the pool waits for its bursts, which use
+    // the channel, the dump and the output
+    std::unique_ptr<message_output> out;
+    std::unique_ptr<burst_dump> dump;
+    std::unique_ptr<channel_decoder> channel;
+    std::unique_ptr<decode_pool> pool;
+    std::unique_ptr<am_frontend> frontend;
+    std::shared_ptr<metrics_server> metrics; ///< removes the channel in ~impl()
+
+    std::vector<char> partial; ///< input of an incomplete chunk or decimation
+    size_t npartial;           ///< samples in partial
+    std::vector<float> fchunk; ///< front end output for the detector
+    int fill;                  ///< samples in fchunk
+    uint64_t nout;             ///< decoder samples given to the detector
+
+    std::mutex mutex; ///< pending, lost
+    std::deque<demod_message> pending;
+    uint64_t lost;
+
+    impl(const config& c);
+    ~impl();
+
+    template <typename T>
+    void push_real(const T* in, size_t n);
+    void push_complex(const std::complex<float>* in, size_t n);
+    void detect_complex(const std::complex<float>* in, size_t n);
+
+    void decoded(const burst& b, decode_status status, const std::string& record) override;
+};
+
+demod::impl::impl(const config& c)
+    : cfg(c), decim(1), npartial(0), fill(0), nout(0), lost(0)
+{
+    // Complex baseband is brought to the decoder rate here
+    double r = cfg.samp_rate;
+    if (cfg.input == INPUT_COMPLEX) {
+        decim = decimation(cfg.samp_rate);
+        r = cfg.samp_rate / decim;
+    }
+    if ((r < 9600) || (std::fabs(r - std::lround(r)) > 1e-6)) {
+        throw std::invalid_argument("acars: the decoder needs an integer rate of "
+                                    "at least 9600 Hz, not " +
+                                    std::to_string(r));
+    }
+    rate = int(std::lround(r));
+    if (cfg.input == INPUT_COMPLEX) {
+        frontend.reset(new am_frontend(decim, rate));
+    }
+
+    out.reset(new message_output(cfg.filename, cfg.segment_size, cfg.rotate_seconds,
+                                 cfg.fsync_interval, cfg.feed, cfg.feed_interval,
+                                 cfg.dedup_window, cfg.dedup_group, cfg.console));
+
+    // Bursts go through a bounded capture ring; the ones selected by the
+    // policy are written by a background thread, never in push()
+    if (cfg.saveall) {
+        dump.reset(new burst_dump(cfg.sigmf ? burst_dump::SIGMF : burst_dump::TEXT,
+                                  cfg.capture_failed ? burst_dump::CAPTURE_FAILED
+                                                     : burst_dump::CAPTURE_ALL,
+                                  cfg.capture_sample > 0 ? cfg.capture_sample : 0,
+                                  rate,
+                                  cfg.capture_dir,
+                                  cfg.capture_tag,
+                                  cfg.capture_depth > 0 ? cfg.capture_depth : 1));
+    }
+    pool.reset(new decode_pool(cfg.decode_threads, cfg.decode_queue));
+    channel.reset(new channel_decoder(cfg.threshold, rate, out.get(), dump.get(),
+                                      pool.get(), cfg.label));
+    channel->set_listener(this);
+    channel->set_console(cfg.console ? stdout : cfg.verbose ? stderr : nullptr);
+    if (cfg.stream_time) {
+        channel->set_start_time(cfg.start);
+    }
+    chunk = channel->chunk();
+    fchunk.resize(chunk);
+    partial.resize(size_t(cfg.input == INPUT_COMPLEX ? decim : chunk) *
+                   sample_size(cfg.input));
+
+    if (cfg.metrics_port > 0) {
+        static std::atomic<int> count(0);
+        std::string name = cfg.metrics_name;
+        if (name.empty()) {
+            name = "demod" + std::to_string(count++);
+        }
+        metrics = metrics_server::get(cfg.metrics_port);
+        metrics->add(name, channel.get(), pool.get(), out.get());
+    }
+}
+
+demod::impl::~impl()
+{
+    if (metrics) {
+        metrics->remove(channel.get());
+    }
+}
+
+// ----------------------------------------------------------------------------
+// push_real(): whole chunks to the detector, the rest kept for the next call
+// ----------------------------------------------------------------------------
+template <typename T>
+void demod::impl::push_real(const T* in, size_t n)
+{
+    T* part = reinterpret_cast<T*>(partial.data());
+    if (npartial > 0) {
+        size_t m = std::min(n, size_t(chunk) - npartial);
+        std::memcpy(part + npartial, in, m * sizeof(T));
+        npartial += m;
+        in += m;
+        n -= m;
+        if (npartial < size_t(chunk)) {
+            return;
+        }
+        channel->process(part, chunk, nout);
+        nout += chunk;
+        npartial = 0;
+    }
+    for (; n >= size_t(chunk); in += chunk, n -= chunk) {
+        channel->process(in, chunk, nout);
+        nout += chunk;
+    }
+    std::memcpy(part, in, n * sizeof(T));
+    npartial = n;
+}
+
+// ----------------------------------------------------------------------------
+// push_complex(): whole decimation periods to the front end
+// ----------------------------------------------------------------------------
+void demod::impl::push_complex(const std::complex<float>* in, size_t n)
+{
+    std::complex<float>* part = reinterpret_cast<std::complex<float>*>(partial.data());
+    if (npartial > 0) {
+        size_t m = std::min(n, size_t(decim) - npartial);
+        std::memcpy(part + npartial, in, m * sizeof(*in));
+        npartial += m;
+        in += m;
+        n -= m;
+        if (npartial < size_t(decim)) {
+            return;
+        }
+        detect_complex(part, 1);
+        npartial = 0;
+    }
+    size_t whole = n / decim;
+    detect_complex(in, whole);
+    in += whole * decim;
+    n -= whole * decim;
+    std::memcpy(part, in, n * sizeof(*in));
+    npartial = n;
+}
+
+// Envelope, DC removal and decimation in one pass, chunk by chunk
+void demod::impl::detect_complex(const std::complex<float>* in, size_t nd)
+{
+    for (size_t k = 0; k < nd;) {
+        int m = int(std::min(nd - k, size_t(chunk - fill)));
+        frontend->process(in + k * decim, m, &fchunk[fill]);
+        fill += m;
+        k += m;
+        if (fill == chunk) {
+            channel->process(fchunk.data(), chunk, nout);
+            nout += chunk;
+            fill = 0;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// decoded(): output of the channel, queued for pull()
+// ----------------------------------------------------------------------------
+void demod::impl::decoded(const burst& b, decode_status status, const std::string& record)
+{
+    if ((cfg.max_pending == 0) || (status == DECODE_NO_SYNC) || record.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.size() >= cfg.max_pending) {
+        pending.pop_front();
+        lost++;
+    }
+    pending.emplace_back();
+    demod_message& m = pending.back();
+    m.offset = b.offset;
+    m.time = b.start;
+    m.bcs_ok = b.bcs_ok;
+    m.frame.assign(b.message.data(), b.nbytes);
+    m.record = record;
+}
+
+// ----------------------------------------------------------------------------
+// demod
+// ----------------------------------------------------------------------------
+demod::demod(const config& cfg) : _impl(new impl(cfg)) {}
+
+demod::~demod() {}
+
+static void check_input(demod::input_type got, demod::input_type want)
+{
+    if (got != want) {
+        throw std::invalid_argument("acars: demod: samples of another type than "
+                                    "configured");
+    }
+}
+
+void demod::push(const float* in, size_t n)
+{
+    stage_timer t(&_impl->channel->stats(), STAGE_PUSH);
+    check_input(INPUT_FLOAT, _impl->cfg.input);
+    _impl->push_real(in, n);
+}
+
+void demod::push(const std::complex<float>* in, size_t n)
+{
+    stage_timer t(&_impl->channel->stats(), STAGE_PUSH);
+    check_input(INPUT_COMPLEX, _impl->cfg.input);
+    _impl->push_complex(in, n);
+}
+
+void demod::push(const int16_t* in, size_t n)
+{
+    stage_timer t(&_impl->channel->stats(), STAGE_PUSH);
+    check_input(INPUT_SHORT, _impl->cfg.input);
+    _impl->push_real(in, n);
+}
+
+void demod::push(const int8_t* in, size_t n)
+{
+    stage_timer t(&_impl->channel->stats(), STAGE_PUSH);
+    check_input(INPUT_CHAR, _impl->cfg.input);
+    _impl->push_real(in, n);
+}
+
+bool demod::pull(demod_message& m)
+{
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    if (_impl->pending.empty()) {
+        return false;
+    }
+    m = std::move(_impl->pending.front());
+    _impl->pending.pop_front();
+    return true;
+}
+
+void demod::flush()
+{
+    impl& d = *_impl;
+    // the samples of the incomplete chunk, then quiet to end the burst
+    if (d.frontend) {
+        if (d.fill > 0) {
+            d.channel->process(d.fchunk.data(), d.fill, d.nout);
+            d.nout += d.fill;
+        }
+    } else if (d.npartial > 0) {
+        const char* p = d.partial.data();
+        const int n = int(d.npartial);
+        switch (d.cfg.input) {
+        case INPUT_SHORT:
+            d.channel->process(reinterpret_cast<const int16_t*>(p), n, d.nout);
+            break;
+        case INPUT_CHAR:
+            d.channel->process(reinterpret_cast<const int8_t*>(p), n, d.nout);
+            break;
+        default:
+            d.channel->process(reinterpret_cast<const float*>(p), n, d.nout);
+            break;
+        }
+        d.nout += n;
+    }
+    d.fill = 0;
+    d.npartial = 0;
+    std::fill(d.fchunk.begin(), d.fchunk.end(), 0.0f);
+    for (int k = 0; (k < 4) && !d.channel->idle(); k++) {
+        d.channel->process(d.fchunk.data(), d.chunk, d.nout);
+        d.nout += d.chunk;
+    }
+    d.pool->wait();
+}
+
+void demod::set_threshold(float threshold) { _impl->channel->set_seuil(threshold); }
+
+int demod::rate() const { return _impl->rate; }
+
+size_t demod::input_multiple() const
+{
+    return _impl->frontend ? size_t(_impl->decim) : size_t(_impl->chunk);
+}
+
+uint64_t demod::decoded() const { return _impl->pool->decoded(); }
+
+uint64_t demod::dropped() const { return _impl->pool->dropped(); }
+
+uint64_t demod::lost_messages() const
+{
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    return _impl->lost;
+}
+
+int demod::queue_depth() { return _impl->pool->queued(); }
+
+int demod::max_queue_depth() { return _impl->pool->max_queued(); }
+
+demod_stats demod::stats() const
+{
+    const impl& d = *_impl;
+    const detector_counters& det = d.channel->detected();
+    const output_counters& out = d.channel->output_counts();
+    demod_stats s = {};
+    s.samples = det.samples.get();
+    s.bursts_detected = det.bursts.get();
+    s.bursts_decoded = out.decoded.get();
+    s.sync_failures = out.no_sync.get();
+    s.crc_failures = out.bad_crc.get();
+    if (s.bursts_detected > 0) {
+        s.mean_burst_ms = 1e3 * double(det.burst_samples.get()) /
+                          double(s.bursts_detected) / d.rate;
+    }
+    s.noise_floor = det.noise.load(std::memory_order_relaxed);
+    s.queue_depth = d.pool->queued();
+    if (s.bursts_decoded > 0) {
+        s.cpu_per_burst_ms = 1e-6 * double(out.cpu_ns.get()) / double(s.bursts_decoded);
+    }
+    s.dropped_bursts = d.pool->dropped();
+    s.dropped_messages = lost_messages() + d.out->feed_dropped() + d.out->log_dropped();
+    s.duplicates = d.out->duplicates();
+    return s;
+}
+
+std::vector<stage_latency> demod::stage_latencies() const
+{
+    return _impl->channel->stats().summary();
+}
+
+void demod::reset_stage_latencies() { _impl->channel->stats().reset(); }
+
+std::string demod::stage_report() const
+{
+    std::vector<stage_latency> v = stage_latencies();
+    if (v.empty()) {
+        return "stage timing not built in (ENABLE_STAGE_TIMING)\n";
+    }
+    std::string r = "stage       count    mean us     p50 us     p90 us     p99 us     max us\n";
+    for (const stage_latency& s : v) {
+        char line[128];
+        std::snprintf(line, sizeof(line), "%-7s %9lu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                      s.name, (unsigned long)s.count, s.mean_us, s.p50_us, s.p90_us,
+                      s.p99_us, s.max_us);
+        r += line;
+    }
+    return r;
+}
+
+} // namespace acars
+} // namespace gr
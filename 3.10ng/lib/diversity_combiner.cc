@@ -0,0 +1,234 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "diversity_combiner.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gr {
+namespace acars {
+
+diversity_combiner::diversity_combiner(int branches,
+                                       uint64_t window,
+                                       message_output* out,
+                                       const std::string& label)
+    : _branches(branches),
+      _window(window),
+      _out(out),
+      _label(label),
+      _settled(branches, 0),
+      _transmissions(0),
+      _picked(0),
+      _combined_ok(0),
+      _failed(0)
+{
+    // "+*" SYN SYN SOH with odd parity, as the slicer sees it: bit idx of
+    // the burst is 1 when bit idx+2 of the frame equals bit idx+1
+    const unsigned char sync[] = { 0xab, 0x2a, 0x16, 0x16, 0x01 };
+    const int nbits = 8 * int(sizeof(sync));
+    std::vector<int> t(nbits);
+    for (int k = 0; k < nbits; k++) {
+        t[k] = (sync[k / 8] >> (k % 8)) & 1;
+    }
+    _header.resize(nbits - 2);
+    for (int idx = 0; idx < nbits - 2; idx++) {
+        _header[idx] = (t[idx + 2] == t[idx + 1]) ? 1.0f : -1.0f;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// add(), settle(), flush()
+// ----------------------------------------------------------------------------
+void diversity_combiner::add(int branch, const burst& b, const struct timespec* when)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    group* g = nullptr;
+    for (group& x : _groups) {
+        uint64_t d = (x.offset > b.offset) ? x.offset - b.offset : b.offset - x.offset;
+        if (!x.copies[branch].valid && (d <= _window)) {
+            g = &x;
+            break;
+        }
+    }
+    if (!g) {
+        auto pos = std::find_if(_groups.begin(), _groups.end(), [&](const group& x) {
+            return x.offset > b.offset;
+        });
+        g = &*_groups.insert(pos, new_group(b.offset));
+    }
+
+    if (when && (!g->dated || (when->tv_sec < g->start.tv_sec) ||
+                 ((when->tv_sec == g->start.tv_sec) &&
+                  (when->tv_nsec < g->start.tv_nsec)))) {
+        g->dated = true;
+        g->start = *when;
+    }
+
+    copy& c = g->copies[branch];
+    c.valid = true;
+    c.offset = b.offset;
+    c.bcs_ok = b.bcs_ok;
+    c.nbytes = b.nbytes;
+    c.message.assign(b.message.begin(), b.message.begin() + b.nbytes);
+    c.nbits = b.nbits;
+    c.soft.assign(b.soft.begin(), b.soft.begin() + b.nbits);
+    float q = 0.0f;
+    for (int k = 0; k < b.nbits; k++) {
+        q += std::fabs(b.soft[k]);
+    }
+    c.quality = (b.nbits > 0) ? q / b.nbits : 0.0f;
+
+    // the bursts of a branch come in stream order
+    _settled[branch] = std::max(_settled[branch], b.offset);
+    resolve_ready();
+}
+
+void diversity_combiner::settle(int branch, uint64_t offset)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _settled[branch] = std::max(_settled[branch], offset);
+    resolve_ready();
+}
+
+void diversity_combiner::flush()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (!_groups.empty()) {
+        resolve(_groups.front());
+        _free.push_back(std::move(_groups.front()));
+        _groups.pop_front();
+    }
+}
+
+diversity_combiner::group diversity_combiner::new_group(uint64_t offset)
+{
+    group g;
+    if (!_free.empty()) {
+        g = std::move(_free.back());
+        _free.pop_back();
+    }
+    g.offset = offset;
+    g.dated = false;
+    g.copies.resize(_branches);
+    for (copy& c : g.copies) {
+        c.valid = false;
+    }
+    return g;
+}
+
+bool diversity_combiner::complete(const group& g) const
+{
+    for (int k = 0; k < _branches; k++) {
+        if (!g.copies[k].valid && (_settled[k] <= g.offset + _window)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Groups are resolved in stream order: a later complete group waits for the
+// earlier ones
+void diversity_combiner::resolve_ready()
+{
+    while (!_groups.empty() && complete(_groups.front())) {
+        resolve(_groups.front());
+        _free.push_back(std::move(_groups.front()));
+        _groups.pop_front();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// resolve(): one output message for the group
+// ----------------------------------------------------------------------------
+void diversity_combiner::resolve(group& g)
+{
+    _transmissions++;
+    const struct timespec* when = g.dated ? &g.start : nullptr;
+
+    const copy* best_ok = nullptr;
+    const copy* best = nullptr;
+    int ncopies = 0;
+    for (const copy& c : g.copies) {
+        if (!c.valid) {
+            continue;
+        }
+        ncopies++;
+        if (!best || (c.quality > best->quality)) {
+            best = &c;
+        }
+        if (c.bcs_ok && (!best_ok || (c.quality > best_ok->quality))) {
+            best_ok = &c;
+        }
+    }
+    if (best_ok) {
+        _picked++;
+        _out->parse(best_ok->message.data(), best_ok->nbytes, _label, when);
+        return;
+    }
+
+    if (ncopies > 1) {
+        // sum of the soft bits, each copy shifted so that its header starts
+        // at bit 0
+        std::vector<float>& s = _combined.soft;
+        const int cap = int(s.size());
+        std::fill(s.begin(), s.end(), 0.0f);
+        int nbits = 0;
+        for (const copy& c : g.copies) {
+            if (!c.valid) {
+                continue;
+            }
+            int d = align(c);
+            for (int j = std::max(0, d); j < c.nbits; j++) {
+                if (j - d < cap) {
+                    s[j - d] += c.soft[j];
+                }
+            }
+            nbits = std::max(nbits, std::min(c.nbits - d, cap));
+        }
+        s[0] = -1.0f;
+        _combined.nbits = nbits;
+        _dec.frame(_combined);
+        if (_combined.bcs_ok) {
+            _combined_ok++;
+            _out->parse(_combined.message.data(), _combined.nbytes, _label, when);
+            return;
+        }
+    }
+
+    _failed++;
+    _out->parse(best->message.data(), best->nbytes, _label, when);
+}
+
+// ----------------------------------------------------------------------------
+// align(): bit of the copy where the frame header starts
+// ----------------------------------------------------------------------------
+int diversity_combiner::align(const copy& c) const
+{
+    const int n = int(_header.size());
+    int best_d = 0;
+    float best_score = -1e30f;
+    for (int d = -MAX_SHIFT; d <= MAX_SHIFT; d++) {
+        float score = 0.0f;
+        for (int idx = 1; idx < n; idx++) {
+            int j = idx + d;
+            if ((j >= 0) && (j < c.nbits)) {
+                score += _header[idx] * c.soft[j];
+            }
+        }
+        if (score > best_score) {
+            best_score = score;
+            best_d = d;
+        }
+    }
+    return best_d;
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,125 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_DIVERSITY_COMBINER_H
+#define INCLUDED_ACARS_DIVERSITY_COMBINER_H
+
+#include "burst_decoder.h"
+#include "message_output.h"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief One output message per transmission received on several receivers.
+ *
+ * The decoders of the receivers (branches) hand their bursts to add(), in
+ * the order each branch detected them. Bursts of different branches whose
+ * stream offsets are less than \p window samples apart belong to the same
+ * transmission; the receivers are assumed to share their sample clock. A
+ * group is resolved once every branch has either given its copy, or
+ * settle()d past the group: it is then known that no copy is coming.
+ *
+ * Resolution: the CRC-valid copy of highest quality (mean soft bit
+ * magnitude) is output if there is one. Otherwise the soft bits of all
+ * copies are aligned on the "+*" SYN SYN SOH header, summed and framed
+ * again, which recovers bits that each receiver got wrong on its own; the
+ * combined frame is output if its BCS matches, else the best single copy.
+ * The message is labelled \p label and, for dated bursts, dated from the
+ * earliest copy.
+ *
+ * add() and settle() may be called from any thread.
+ */
+class diversity_combiner
+{
+public:
+    static const int MAX_SHIFT = 16; ///< header search range, in bits
+
+private:
+    struct copy {
+        bool valid;                 ///< the branch gave a burst
+        uint64_t offset;
+        bool bcs_ok;
+        float quality;              ///< mean |soft|
+        int nbytes;
+        std::vector<char> message;
+        int nbits;
+        std::vector<float> soft;
+    };
+    struct group {
+        uint64_t offset;         ///< of the first copy
+        bool dated;              ///< the copies came with a time
+        struct timespec start;   ///< time of the earliest copy, if dated
+        std::vector<copy> copies; ///< one per branch
+    };
+
+    int _branches;
+    uint64_t _window;
+    message_output* _out;
+    std::string _label;         ///< Channel= line of the records, may be empty
+    std::vector<float> _header; ///< expected +/-1 bits of "+*" SYN SYN SOH
+
+    std::mutex _mutex;
+    std::deque<group> _groups;    ///< unresolved, by offset
+    std::vector<group> _free;     ///< recycled groups and their buffers
+    std::vector<uint64_t> _settled; ///< per branch: no burst before this
+    burst_decoder _dec;           ///< frames the combined copies
+    burst _combined;
+
+    uint64_t _transmissions;
+    uint64_t _picked;   ///< resolved by a CRC-valid copy
+    uint64_t _combined_ok; ///< resolved by soft combining
+    uint64_t _failed;   ///< no valid copy, combined or not
+
+    group new_group(uint64_t offset);
+    bool complete(const group& g) const;
+    void resolve_ready();
+    void resolve(group& g);
+    int align(const copy& c) const;
+
+public:
+    diversity_combiner(int branches,
+                       uint64_t window,
+                       message_output* out,
+                       const std::string& label = "");
+
+    //! Decoded burst of \p branch, starting at \p when if dated
+    void add(int branch, const burst& b, const struct timespec* when = nullptr);
+    //! \p branch will give no burst starting before \p offset
+    void settle(int branch, uint64_t offset);
+    //! Resolve all the groups, at the end of the stream
+    void flush();
+
+    uint64_t transmissions() const { return _transmissions; }
+    uint64_t picked() const { return _picked; }
+    uint64_t combined() const { return _combined_ok; }
+    uint64_t failed() const { return _failed; }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_DIVERSITY_COMBINER_H */
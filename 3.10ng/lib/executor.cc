@@ -0,0 +1,165 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "executor.h"
+#include "trace_buffer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+// index of the worker running on this thread, -1 outside of the executors
+static thread_local int worker_index = -1;
+static thread_local const executor* worker_owner = nullptr;
+
+// ACARS_PIN_DECODERS set, and not to 0
+static bool pin_from_environment()
+{
+    const char* pin = std::getenv("ACARS_PIN_DECODERS");
+    return pin && (*pin != '\0') && (std::string(pin) != "0");
+}
+
+executor::executor(int workers)
+    : _next(0), _pending(0), _steals(0), _pin(pin_from_environment()), _running(true)
+{
+    if (workers <= 0) {
+        workers = int(std::thread::hardware_concurrency());
+    }
+    if (workers <= 0) {
+        workers = 1;
+    }
+    for (int k = 0; k < workers; k++) {
+        _queues.emplace_back(new queue());
+    }
+    for (int k = 0; k < workers; k++) {
+        _threads.emplace_back(&executor::worker, this, k);
+    }
+}
+
+executor::~executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _cond.notify_all();
+    for (auto& t : _threads) {
+        t.join();
+    }
+}
+
+std::shared_ptr<executor> executor::get(int workers)
+{
+    static std::mutex registry_mutex;
+    static std::weak_ptr<executor> shared;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::shared_ptr<executor> e = shared.lock();
+    if (!e) {
+        e = std::make_shared<executor>(workers);
+        shared = e;
+        std::fprintf(stderr, "decode executor: %d worker threads\n", e->workers());
+    } else if ((workers > 0) && (workers != e->workers())) {
+        std::fprintf(stderr, "decode executor: keeping the %d workers of the first block\n",
+                     e->workers());
+    }
+    return e;
+}
+
+void executor::submit(task* t)
+{
+    // a worker submitting keeps the task for itself, others spread them
+    int n = int(_queues.size());
+    int k = ((worker_owner == this) && (worker_index >= 0))
+                ? worker_index
+                : int(_next.fetch_add(1, std::memory_order_relaxed) % n);
+    {
+        std::lock_guard<std::mutex> lock(_queues[k]->mutex);
+        _queues[k]->tasks.push_back(t);
+    }
+    {
+        // under the sleep lock, so that a worker about to wait sees it
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    _cond.notify_one();
+}
+
+// newest task of our deque, else the oldest one of another deque
+executor::task* executor::pop(int self)
+{
+    int n = int(_queues.size());
+    {
+        queue& q = *_queues[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            return q.tasks.pop_back();
+        }
+    }
+    for (int k = 1; k < n; k++) {
+        queue& q = *_queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            task* t = q.tasks.pop_front();
+            _steals.fetch_add(1, std::memory_order_relaxed);
+            return t;
+        }
+    }
+    return nullptr;
+}
+
+void executor::worker(int self)
+{
+    worker_index = self;
+    worker_owner = this;
+    trace_thread_name("decode " + std::to_string(self));
+
+    // on request, one worker per core, as far as the affinity mask allows:
+    // unpinned, the kernel can move a worker off a core that the scheduler
+    // threads or other programs need
+    cpu_set_t cpus;
+    if (_pin && (pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0)) {
+        int count = CPU_COUNT(&cpus);
+        if (count > 1) {
+            int target = self % count;
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &cpus) && (target-- == 0)) {
+                    cpu_set_t one;
+                    CPU_ZERO(&one);
+                    CPU_SET(cpu, &one);
+                    pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (;;) {
+        task* t = pop(self);
+        if (t) {
+            _pending.fetch_sub(1, std::memory_order_relaxed);
+            t->run();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this] {
+            return (_pending.load(std::memory_order_relaxed) > 0) || !_running;
+        });
+        if (!_running && (_pending.load(std::memory_order_relaxed) == 0)) {
+            return; // stopped and drained
+        }
+    }
+}
+
+} // namespace acars
+} // namespace gr
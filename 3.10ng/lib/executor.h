@@ -0,0 +1,132 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_EXECUTOR_H
+#define INCLUDED_ACARS_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Fixed set of worker threads with work stealing, shared by the
+ * decode pools of all the blocks of a process.
+ *
+ * Each worker has its own deque. The workers are left to the kernel
+ * scheduler, unless the environment variable ACARS_PIN_DECODERS is set
+ * (and not 0): each one is then pinned to a core of the affinity mask.
+ * Tasks submitted from outside (the scheduler threads) are spread round
+ * robin over the deques; a worker takes the newest task of its own deque,
+ * and when it is empty steals the oldest task of another one. A channel
+ * with a backlog of bursts therefore keeps all the cores busy, whichever
+ * block it belongs to.
+ */
+class executor
+{
+public:
+    struct task {
+        virtual ~task() {}
+        virtual void run() = 0;
+    };
+
+private:
+    /*!
+     * \brief Deque of tasks on a ring that only grows, so that queuing does
+     * not allocate once the ring has held the largest backlog.
+     */
+    class task_deque
+    {
+    private:
+        std::vector<task*> _ring;
+        size_t _head;  ///< index of the oldest task
+        size_t _count;
+
+    public:
+        task_deque() : _ring(64), _head(0), _count(0) {}
+
+        bool empty() const { return _count == 0; }
+        void push_back(task* t)
+        {
+            if (_count == _ring.size()) {
+                std::vector<task*> ring(2 * _ring.size());
+                for (size_t k = 0; k < _count; k++) {
+                    ring[k] = _ring[(_head + k) % _ring.size()];
+                }
+                _ring.swap(ring);
+                _head = 0;
+            }
+            _ring[(_head + _count++) % _ring.size()] = t;
+        }
+        task* pop_back() { return _ring[(_head + --_count) % _ring.size()]; }
+        task* pop_front()
+        {
+            task* t = _ring[_head];
+            _head = (_head + 1) % _ring.size();
+            _count--;
+            return t;
+        }
+    };
+
+    struct queue {
+        std::mutex mutex;
+        task_deque tasks;
+    };
+
+    std::vector<std::unique_ptr<queue>> _queues; ///< one per worker
+    std::atomic<unsigned> _next;                 ///< round robin for submit()
+    std::atomic<int> _pending;                   ///< tasks in all the deques
+    std::atomic<uint64_t> _steals;
+    bool _pin; ///< one core per worker, from ACARS_PIN_DECODERS
+
+    std::mutex _mutex; ///< sleeping workers
+    std::condition_variable _cond;
+    bool _running;
+    std::vector<std::thread> _threads;
+
+    task* pop(int self);
+    void worker(int self);
+
+public:
+    explicit executor(int workers);
+    ~executor(); ///< runs the queued tasks, then joins the workers
+
+    /*!
+     * \brief Executor shared by the process, created with the given number
+     * of workers (<= 0: one per core) by its first user.
+     */
+    static std::shared_ptr<executor> get(int workers);
+
+    //! Queue t; t->run() is called once on a worker, t is not deleted
+    void submit(task* t);
+
+    int workers() const { return int(_threads.size()); }
+    uint64_t steals() const { return _steals.load(std::memory_order_relaxed); }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_EXECUTOR_H */
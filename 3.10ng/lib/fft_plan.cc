@@ -0,0 +1,151 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "fft_plan.h"
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+namespace gr {
+namespace acars {
+
+namespace {
+
+void (*planner_lock_hook)() = nullptr;
+void (*planner_unlock_hook)() = nullptr;
+std::mutex hooks_mutex; ///< guards the hooks, not the planner
+
+// The planner lock of the process, for the scope of a plan call
+class planner_lock
+{
+private:
+    void (*_unlock)();
+
+public:
+    planner_lock()
+    {
+        void (*lock)();
+        {
+            std::lock_guard<std::mutex> guard(hooks_mutex);
+            lock = planner_lock_hook;
+            _unlock = planner_unlock_hook;
+        }
+        if (lock) {
+            lock();
+        } else {
+            // no gr::fft in the process: FFTW serializes its planner itself
+            static std::once_flag once;
+            std::call_once(once, [] { fftwf_make_planner_thread_safe(); });
+        }
+    }
+    ~planner_lock()
+    {
+        if (_unlock) {
+            _unlock();
+        }
+    }
+
+    planner_lock(const planner_lock&) = delete;
+    planner_lock& operator=(const planner_lock&) = delete;
+};
+
+} // namespace
+
+void fft_plan::set_planner_lock(void (*lock)(), void (*unlock)())
+{
+    std::lock_guard<std::mutex> guard(hooks_mutex);
+    planner_lock_hook = lock;
+    planner_unlock_hook = unlock;
+}
+
+fft_plan::fft_plan(int n, bool forward) : _n(n), _owned(true)
+{
+    planner_lock lock;
+    _in = reinterpret_cast<std::complex<float>*>(fftwf_alloc_complex(size_t(n)));
+    _out = reinterpret_cast<std::complex<float>*>(fftwf_alloc_complex(size_t(n)));
+    _plan = (_in && _out) ? fftwf_plan_dft_1d(n,
+                                              reinterpret_cast<fftwf_complex*>(_in),
+                                              reinterpret_cast<fftwf_complex*>(_out),
+                                              forward ? FFTW_FORWARD : FFTW_BACKWARD,
+                                              FFTW_ESTIMATE)
+                          : nullptr;
+    if (!_plan) {
+        fftwf_free(_in);
+        fftwf_free(_out);
+        throw std::bad_alloc();
+    }
+}
+
+fft_plan::fft_plan(int n, bool forward, std::complex<float>* data)
+    : _n(n), _in(data), _out(data), _owned(false)
+{
+    planner_lock lock;
+    // FFTW_ESTIMATE does not touch the arrays
+    _plan = fftwf_plan_dft_1d(n,
+                              reinterpret_cast<fftwf_complex*>(data),
+                              reinterpret_cast<fftwf_complex*>(data),
+                              forward ? FFTW_FORWARD : FFTW_BACKWARD,
+                              FFTW_ESTIMATE);
+    if (!_plan) {
+        throw std::bad_alloc();
+    }
+}
+
+fft_plan::~fft_plan()
+{
+    planner_lock lock;
+    fftwf_destroy_plan(_plan);
+    if (_owned) {
+        fftwf_free(_in);
+        fftwf_free(_out);
+    }
+}
+
+int fft_plan::good_size(int n)
+{
+    int best = 1;
+    while (best < n) {
+        best *= 2;
+    }
+    for (int p5 = 1; p5 < best; p5 *= 5) {
+        for (int p35 = p5; p35 < best; p35 *= 3) {
+            int m = p35;
+            while (m < n) {
+                m *= 2;
+            }
+            best = std::min(best, m);
+        }
+    }
+    return best;
+}
+
+// ----------------------------------------------------------------------------
+// fft_buffer
+// ----------------------------------------------------------------------------
+fft_buffer::fft_buffer(int n) : _data(nullptr), _size(0) { reserve(n); }
+
+fft_buffer::~fft_buffer() { fftwf_free(_data); }
+
+void fft_buffer::reserve(int n)
+{
+    if (n <= _size) {
+        return;
+    }
+    std::complex<float>* d =
+        reinterpret_cast<std::complex<float>*>(fftwf_alloc_complex(size_t(n)));
+    if (!d) {
+        throw std::bad_alloc();
+    }
+    fftwf_free(_data);
+    _data = d;
+    _size = n;
+}
+
+} // namespace acars
+} // namespace gr
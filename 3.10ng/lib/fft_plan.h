@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_FFT_PLAN_H
+#define INCLUDED_ACARS_FFT_PLAN_H
+
+#include <complex>
+#include <fftw3.h>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief One-dimensional complex FFT of a fixed size, on FFTW.
+ *
+ * The decoder core does not depend on gr::fft: this is the part of it that
+ * acars_dec() uses, with the input and output buffers owned by the plan.
+ * Plans are made with FFTW_ESTIMATE, as a decoder makes them whenever it
+ * meets a new transform length, on the decode threads; the FFTW planner is
+ * not thread-safe, so plans are made and destroyed under the planner lock
+ * of the process: the one installed by set_planner_lock(), which the blocks
+ * set to that of gr::fft, else FFTW's own, turned on before the first plan.
+ * execute() may run concurrently on distinct plans.
+ *
+ * A plan may also be made in place on a caller's buffer, and then applied
+ * to any fft_buffer of at least its length, so that a decoder keeps its
+ * plans and buffers from burst to burst.
+ */
+class fft_plan
+{
+private:
+    int _n;
+    std::complex<float>* _in;
+    std::complex<float>* _out;
+    bool _owned; ///< _in and _out were allocated by the plan
+    fftwf_plan _plan;
+
+public:
+    //! Plan of \p n points, e^-2i.pi.k.t/n if \p forward, else e^+2i.pi.k.t/n
+    fft_plan(int n, bool forward);
+    //! In-place plan on \p data, an fft_buffer of at least \p n points,
+    //! which is not overwritten
+    fft_plan(int n, bool forward, std::complex<float>* data);
+    ~fft_plan();
+
+    fft_plan(const fft_plan&) = delete;
+    fft_plan& operator=(const fft_plan&) = delete;
+
+    int size() const { return _n; }
+    std::complex<float>* in() { return _in; }
+    std::complex<float>* out() { return _out; }
+    //! Transform in() to out(), unnormalized
+    void execute() { fftwf_execute(_plan); }
+    //! Transform \p data in place, for a plan made in place; \p data comes
+    //! from an fft_buffer, aligned as FFTW expects
+    void execute(std::complex<float>* data)
+    {
+        fftwf_execute_dft(_plan,
+                          reinterpret_cast<fftwf_complex*>(data),
+                          reinterpret_cast<fftwf_complex*>(data));
+    }
+
+    /*!
+     * \brief The smallest length of at least \p n points with no prime
+     * factor above 5, which FFTW transforms fastest. Rounding the bursts up
+     * to these lengths also bounds the number of plans a decoder keeps.
+     */
+    static int good_size(int n);
+
+    /*!
+     * \brief Make and destroy the plans between \p lock() and \p unlock(),
+     * which take the planner lock shared with the other FFTW users of the
+     * process. Installed before the first plan, when the library is loaded.
+     */
+    static void set_planner_lock(void (*lock)(), void (*unlock)());
+};
+
+/*!
+ * \brief FFTW-aligned complex buffer, which only grows.
+ */
+class fft_buffer
+{
+private:
+    std::complex<float>* _data;
+    int _size;
+
+public:
+    explicit fft_buffer(int n = 0);
+    ~fft_buffer();
+
+    fft_buffer(const fft_buffer&) = delete;
+    fft_buffer& operator=(const fft_buffer&) = delete;
+
+    //! At least \p n points, the contents lost if it grows
+    void reserve(int n);
+    int size() const { return _size; }
+    std::complex<float>* data() { return _data; }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_FFT_PLAN_H */
@@ -0,0 +1,153 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "fixed_point.h"
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ACARS_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ACARS_SSE2
+#endif
+
+namespace gr {
+namespace acars {
+
+// ----------------------------------------------------------------------------
+// Vector accumulation of 8 int16 samples into 64-bit sums
+// ----------------------------------------------------------------------------
+// A pair of squares can reach 2^31 (two -32768), which only fits in an
+// unsigned 32-bit lane: the squares are widened as unsigned, the sums signed.
+namespace {
+
+#if defined(ACARS_NEON)
+
+struct accumulator {
+    int64x2_t sum;
+    uint64x2_t sumsq;
+
+    accumulator() : sum(vdupq_n_s64(0)), sumsq(vdupq_n_u64(0)) {}
+
+    void add(int16x8_t v)
+    {
+        int16x4_t lo = vget_low_s16(v);
+        int16x4_t hi = vget_high_s16(v);
+        int32x4_t q = vmlal_s16(vmull_s16(lo, lo), hi, hi);
+        sumsq = vpadalq_u32(sumsq, vreinterpretq_u32_s32(q));
+        sum = vpadalq_s32(sum, vpaddlq_s16(v));
+    }
+
+    void reduce(sample_stats& s) const
+    {
+        s.sum += vgetq_lane_s64(sum, 0) + vgetq_lane_s64(sum, 1);
+        s.sumsq += int64_t(vgetq_lane_u64(sumsq, 0) + vgetq_lane_u64(sumsq, 1));
+    }
+};
+
+#elif defined(ACARS_SSE2)
+
+struct accumulator {
+    __m128i sum;
+    __m128i sumsq;
+
+    accumulator() : sum(_mm_setzero_si128()), sumsq(_mm_setzero_si128()) {}
+
+    void add(__m128i v)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i s = _mm_madd_epi16(v, _mm_set1_epi16(1));
+        __m128i q = _mm_madd_epi16(v, v);
+        __m128i sign = _mm_srai_epi32(s, 31);
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(s, sign));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(s, sign));
+        sumsq = _mm_add_epi64(sumsq, _mm_unpacklo_epi32(q, zero));
+        sumsq = _mm_add_epi64(sumsq, _mm_unpackhi_epi32(q, zero));
+    }
+
+    void reduce(sample_stats& s) const
+    {
+        alignas(16) int64_t a[2], b[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(a), sum);
+        _mm_store_si128(reinterpret_cast<__m128i*>(b), sumsq);
+        s.sum += a[0] + a[1];
+        s.sumsq += b[0] + b[1];
+    }
+};
+
+#endif
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// stats_s16(), stats_s8(): sums of one detector chunk
+// ----------------------------------------------------------------------------
+sample_stats stats_s16(const int16_t* x, int n)
+{
+    sample_stats s = { 0, 0 };
+    int k = 0;
+#if defined(ACARS_NEON)
+    accumulator acc;
+    for (; k + 8 <= n; k += 8) {
+        acc.add(vld1q_s16(x + k));
+    }
+    acc.reduce(s);
+#elif defined(ACARS_SSE2)
+    accumulator acc;
+    for (; k + 8 <= n; k += 8) {
+        acc.add(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + k)));
+    }
+    acc.reduce(s);
+#endif
+    for (; k < n; k++) {
+        s.sum += x[k];
+        s.sumsq += int32_t(x[k]) * x[k];
+    }
+    return s;
+}
+
+sample_stats stats_s8(const int8_t* x, int n)
+{
+    sample_stats s = { 0, 0 };
+    int k = 0;
+#if defined(ACARS_NEON)
+    accumulator acc;
+    for (; k + 16 <= n; k += 16) {
+        int8x16_t v = vld1q_s8(x + k);
+        acc.add(vmovl_s8(vget_low_s8(v)));
+        acc.add(vmovl_s8(vget_high_s8(v)));
+    }
+    acc.reduce(s);
+#elif defined(ACARS_SSE2)
+    accumulator acc;
+    for (; k + 16 <= n; k += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + k));
+        // sign extension: the byte in the high half, shifted back down
+        acc.add(_mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8));
+        acc.add(_mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8));
+    }
+    acc.reduce(s);
+#endif
+    for (; k < n; k++) {
+        s.sum += x[k];
+        s.sumsq += int32_t(x[k]) * x[k];
+    }
+    return s;
+}
+
+float stats_stddev(const sample_stats& s, int n, float scale)
+{
+    // n times the variance
+    double var = double(s.sumsq) - double(s.sum) * double(s.sum) / n;
+    return float(std::sqrt((var > 0.0) ? var / n : 0.0)) * scale;
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,52 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_FIXED_POINT_H
+#define INCLUDED_ACARS_FIXED_POINT_H
+
+#include <cstdint>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Exact first and second order sums of a block of integer samples.
+ *
+ * This is what the burst detector needs from each chunk: its mean and
+ * standard deviation. For 8 and 16-bit input they are computed in integer
+ * arithmetic with 64-bit accumulators (NEON on ARM, SSE2 on x86, scalar
+ * elsewhere), so the result does not depend on the summation order and the
+ * samples are read once, at their own width.
+ */
+struct sample_stats {
+    int64_t sum;   ///< sum of the samples
+    int64_t sumsq; ///< sum of their squares
+};
+
+sample_stats stats_s16(const int16_t* x, int n);
+sample_stats stats_s8(const int8_t* x, int n);
+
+//! Standard deviation of the n samples summed in s, times scale
+float stats_stddev(const sample_stats& s, int n, float scale);
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_FIXED_POINT_H */
@@ -0,0 +1,189 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "acars_bcs.h"
+#include <acars/generator.h>
+#include <cmath>
+#include <stdexcept>
+
+namespace gr {
+namespace acars {
+
+namespace {
+
+const double BIT_RATE = 2400.0;
+const int MAX_TEXT = 220;
+
+unsigned char odd_parity(unsigned char c)
+{
+    int ones = 0;
+    for (int b = 0; b < 7; b++) {
+        ones += (c >> b) & 1;
+    }
+    return (ones & 1) ? c : (c | 0x80);
+}
+
+void put(std::vector<unsigned char>& f, const std::string& s, size_t size, const char* what)
+{
+    if (s.size() != size) {
+        throw std::invalid_argument(std::string("acars generator: ") + what + " must have " +
+                                    std::to_string(size) + " characters");
+    }
+    for (char c : s) {
+        if ((unsigned char)c & 0x80) {
+            throw std::invalid_argument(std::string("acars generator: ") + what +
+                                        " is not 7-bit");
+        }
+        f.push_back(odd_parity((unsigned char)c));
+    }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Constructor
+// ----------------------------------------------------------------------------
+generator::generator(const config& cfg)
+    : _cfg(cfg),
+      _sigma(0.0),
+      _level2400(cfg.amplitude * std::pow(10.0f, cfg.imbalance_db / 20.0f)),
+      _phase(0.0),
+      _clock(0.0),
+      _first(0),
+      _dropped(0),
+      _elapsed(0.0),
+      _rng(cfg.seed),
+      _normal(0.0f, 1.0f)
+{
+    if (cfg.samp_rate < 9600) {
+        throw std::invalid_argument("acars generator: the rate must be at least 9600 Hz");
+    }
+    if ((cfg.amplitude < 0.0f) || (cfg.gap < 0.0) || (cfg.align < 0) ||
+        (cfg.prekey_bits < 0)) {
+        throw std::invalid_argument(
+            "acars generator: negative amplitude, gap, alignment or pre-key");
+    }
+    // Eb/N0: the tone power over the noise in a band of the bit rate, the
+    // noise being white up to half the sample rate
+    if (std::isfinite(cfg.snr_db)) {
+        double power = 0.5 * double(cfg.amplitude) * cfg.amplitude;
+        double snr = std::pow(10.0, cfg.snr_db / 10.0);
+        _sigma = std::sqrt(power / snr * (cfg.samp_rate / 2) / BIT_RATE);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// frame(): the characters of a block, with parity, BCS and DEL
+// ----------------------------------------------------------------------------
+std::vector<unsigned char> generator::frame(const acars_message& m)
+{
+    if (m.text.size() > MAX_TEXT) {
+        throw std::invalid_argument("acars generator: text longer than 220 characters");
+    }
+    std::vector<unsigned char> f;
+    for (unsigned char c : { 0x2b, 0x2a, 0x16, 0x16, 0x01 }) { // "+*" SYN SYN SOH
+        f.push_back(odd_parity(c));
+    }
+    put(f, std::string(1, m.mode), 1, "mode");
+    put(f, m.address, 7, "address");
+    put(f, std::string(1, m.ack), 1, "ack");
+    put(f, m.label, 2, "label");
+    put(f, std::string(1, m.block_id), 1, "block id");
+    f.push_back(odd_parity(0x02)); // STX
+    put(f, m.msn, 4, "msn");
+    put(f, m.flight, 6, "flight");
+    put(f, m.text, m.text.size(), "text");
+    f.push_back(odd_parity(m.etb ? 0x17 : 0x03));
+
+    // from the character after SOH to ETX included, LSB first
+    uint16_t bcs = acars_bcs(&f[5], int(f.size()) - 5);
+    f.push_back(bcs & 0xff);
+    f.push_back(bcs >> 8);
+    f.push_back(odd_parity(0x7f)); // DEL
+    return f;
+}
+
+// ----------------------------------------------------------------------------
+// add(): a gap, the pre-key, then the bits of the frame
+// ----------------------------------------------------------------------------
+uint64_t generator::add(const acars_message& m) { return add(frame(m)); }
+
+uint64_t generator::add(const std::vector<unsigned char>& frame)
+{
+    add_noise(_cfg.gap);
+    if (_cfg.align > 0) {
+        uint64_t at = _dropped + _samples.size();
+        size_t pad = size_t((_cfg.align - at % _cfg.align) % _cfg.align);
+        add_noise(double(pad) / _cfg.samp_rate);
+    }
+    size_t first = _samples.size();
+    _phase = 0.0;
+    _clock = 0.0;
+    _first = first;
+
+    // MSK: a full 2400 Hz cycle for a bit equal to the previous one, half a
+    // 1200 Hz cycle for a change. The pre-key is ones, and so is the byte
+    // after DEL, sent while the carrier drops.
+    int last = 1;
+    for (int k = 0; k < _cfg.prekey_bits; k++) {
+        bit(1.0, _level2400);
+    }
+    for (size_t k = 0; k <= frame.size(); k++) {
+        unsigned char c = (k < frame.size()) ? frame[k] : 0xff;
+        for (int b = 0; b < 8; b++) {
+            int v = (c >> b) & 1;
+            if (v == last) {
+                bit(1.0, _level2400);
+            } else {
+                bit(0.5, _cfg.amplitude);
+            }
+            last = v;
+        }
+    }
+    return _dropped + first;
+}
+
+void generator::add_noise(double seconds)
+{
+    size_t n = size_t(std::lround(seconds * _cfg.samp_rate));
+    for (size_t k = 0; k < n; k++) {
+        _samples.push_back(_cfg.dc + noise());
+    }
+    _elapsed += double(n) / _cfg.samp_rate;
+}
+
+void generator::clear()
+{
+    _dropped += _samples.size();
+    _samples.clear();
+}
+
+// ----------------------------------------------------------------------------
+// bit(): the samples of one bit, at the current clock error
+// ----------------------------------------------------------------------------
+// The bit ends are kept in samples, exact for the usual rates without clock
+// error, so that the bit length does not wander with rounding.
+void generator::bit(double cycles, float level)
+{
+    double ppm = _cfg.clock_ppm + _cfg.drift_ppm_s * _elapsed;
+    double spb = _cfg.samp_rate / (BIT_RATE * (1.0 + 1e-6 * ppm));
+    _clock += spb;
+    size_t n = 0;
+    for (; double(_samples.size() - _first) < _clock; n++) {
+        _samples.push_back(_cfg.dc + level * float(std::sin(2.0 * M_PI * _phase)) + noise());
+        _phase += cycles / spb;
+    }
+    _phase -= std::floor(_phase);
+    _elapsed += double(n) / _cfg.samp_rate;
+}
+
+float generator::noise() { return (_sigma > 0.0) ? float(_sigma) * _normal(_rng) : 0.0f; }
+
+} // namespace acars
+} // namespace gr
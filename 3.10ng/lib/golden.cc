@@ -0,0 +1,286 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * Decodes a recording and compares its frames, aircraft registration,
+ * flight number, text and BCS status, with a checked-in golden set, one
+ * frame per line:
+ *
+ *   bcs<TAB>registration<TAB>flight<TAB>text
+ *
+ * bcs is "ok" or "bad"; the characters outside 0x20..0x7e, and the
+ * backslash, are written \xNN. The wall time of the decoding is printed as
+ * a CTest measurement, and appended to -t as "recording seconds x_real_time".
+ * After a change meant to alter the frames, rewrite the set with -u.
+ *
+ * usage: acars_golden [-u] [-t times] golden recording.wav
+ *
+ * The recording is a mono WAV file, 8 or 16 bits PCM or 32-bit float.
+ */
+
+#include <acars/demod.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+// offsets in demod_message::frame: "+*", two SYN, SOH, then the fields
+const size_t ADDRESS = 6; // 7 characters, after the mode
+const size_t FLIGHT = 22; // 6 characters, after label, block id, STX and MSN
+const size_t TEXT = 28;
+
+const char ETX = 0x03;
+const char ETB = 0x17;
+
+struct wav {
+    int rate = 0;
+    int bits = 0; ///< 8 or 16: PCM, 32: float
+    std::vector<char> data;
+};
+
+uint32_t le32(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return uint32_t(u[0]) | (uint32_t(u[1]) << 8) | (uint32_t(u[2]) << 16) |
+           (uint32_t(u[3]) << 24);
+}
+
+uint16_t le16(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return uint16_t(u[0] | (u[1] << 8));
+}
+
+// The data chunk goes to the end of the file if its size is not set, as
+// in recordings written from a stream
+wav read_wav(const char* path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error(std::string(path) + ": cannot open");
+    }
+    std::string f((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const char* p = f.data();
+    if ((f.size() < 12) || std::memcmp(p, "RIFF", 4) || std::memcmp(p + 8, "WAVE", 4)) {
+        throw std::runtime_error(std::string(path) + ": not a WAV file");
+    }
+    wav w;
+    int tag = 0;
+    size_t pos = 12;
+    while (pos + 8 <= f.size()) {
+        size_t size = le32(p + pos + 4);
+        if (!std::memcmp(p + pos, "fmt ", 4) && (size >= 16)) {
+            tag = le16(p + pos + 8);
+            if (le16(p + pos + 10) != 1) {
+                throw std::runtime_error(std::string(path) + ": not mono");
+            }
+            w.rate = int(le32(p + pos + 12));
+            w.bits = le16(p + pos + 22);
+        } else if (!std::memcmp(p + pos, "data", 4)) {
+            pos += 8;
+            if ((size == 0) || (size > f.size() - pos)) {
+                size = f.size() - pos;
+            }
+            w.data.assign(p + pos, p + pos + size);
+            break;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    if (!(((tag == 1) && ((w.bits == 8) || (w.bits == 16))) ||
+          ((tag == 3) && (w.bits == 32))) ||
+        w.data.empty()) {
+        throw std::runtime_error(std::string(path) + ": unsupported WAV file");
+    }
+    return w;
+}
+
+std::string escape(const std::string& s)
+{
+    std::string out;
+    for (char c : s) {
+        if ((c >= 0x20) && (c < 0x7f) && (c != '\\')) {
+            out += c;
+        } else {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "\\x%02x", unsigned(uint8_t(c)));
+            out += hex;
+        }
+    }
+    return out;
+}
+
+std::string field(const std::string& frame, size_t first, size_t length)
+{
+    return (first < frame.size()) ? frame.substr(first, length) : std::string();
+}
+
+// The line of a frame in the golden set
+std::string line(const demod_message& m)
+{
+    const std::string& f = m.frame;
+    std::string text;
+    if (f.size() > TEXT) {
+        size_t end = f.find_first_of(std::string{ ETX, ETB }, TEXT);
+        text = f.substr(TEXT, (end == std::string::npos) ? std::string::npos : end - TEXT);
+    }
+    return std::string(m.bcs_ok ? "ok" : "bad") + "\t" +
+           escape(field(f, ADDRESS, 7)) + "\t" + escape(field(f, FLIGHT, 6)) + "\t" +
+           escape(text);
+}
+
+std::vector<std::string> read_lines(const char* path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error(std::string(path) + ": cannot open");
+    }
+    std::vector<std::string> lines;
+    std::string l;
+    while (std::getline(in, l)) {
+        if (!l.empty() && (l[0] != '#')) {
+            lines.push_back(l);
+        }
+    }
+    return lines;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool update = false;
+    const char* times = nullptr;
+    int opt;
+    while ((opt = getopt(argc, argv, "ut:")) != -1) {
+        switch (opt) {
+        case 'u':
+            update = true;
+            break;
+        case 't':
+            times = optarg;
+            break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind + 2 != argc) {
+        std::fprintf(stderr, "usage: %s [-u] [-t times] golden recording.wav\n",
+                     argv[0]);
+        return 2;
+    }
+    const char* golden = argv[optind];
+    const char* path = argv[optind + 1];
+
+    std::vector<std::string> expected;
+    wav w;
+    try {
+        if (!update) {
+            expected = read_lines(golden);
+        }
+        w = read_wav(path);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+
+    demod::config cfg;
+    cfg.samp_rate = w.rate;
+    cfg.input = (w.bits == 32) ? demod::INPUT_FLOAT
+                : (w.bits == 16) ? demod::INPUT_SHORT
+                                 : demod::INPUT_CHAR;
+    cfg.stream_time = true;
+    std::vector<int8_t> s8;
+    if (w.bits == 8) {
+        // unsigned in the file
+        s8.resize(w.data.size());
+        for (size_t k = 0; k < s8.size(); k++) {
+            s8[k] = int8_t(uint8_t(w.data[k]) ^ 0x80);
+        }
+    }
+    const size_t count = w.data.size() / size_t(w.bits / 8);
+
+    std::vector<std::string> found;
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        demod d(cfg);
+        const size_t n = d.input_multiple();
+        demod_message m;
+        for (size_t k = 0; k < count; k += n) {
+            size_t len = std::min(n, count - k);
+            if (w.bits == 32) {
+                d.push(reinterpret_cast<const float*>(w.data.data()) + k, len);
+            } else if (w.bits == 16) {
+                d.push(reinterpret_cast<const int16_t*>(w.data.data()) + k, len);
+            } else {
+                d.push(s8.data() + k, len);
+            }
+            while (d.pull(m)) {
+                found.push_back(line(m));
+            }
+        }
+        d.flush();
+        while (d.pull(m)) {
+            found.push_back(line(m));
+        }
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    double duration = double(count) / w.rate;
+
+    std::printf("%s: %.1f s of signal, %zu frames, decoded in %.3f s (%.0fx real time)\n"
+                "<DartMeasurement name=\"wall_time\" type=\"numeric/double\">%.4f"
+                "</DartMeasurement>\n",
+                path, duration, found.size(), seconds, duration / seconds, seconds);
+    std::fflush(stdout);
+    if (times) {
+        FILE* t = std::fopen(times, "a");
+        if (t) {
+            std::fprintf(t, "%s %.4f %.1f\n", path, seconds, duration / seconds);
+            std::fclose(t);
+        } else {
+            std::perror(times);
+        }
+    }
+
+    if (update) {
+        FILE* o = std::fopen(golden, "w");
+        if (!o) {
+            std::perror(golden);
+            return 2;
+        }
+        std::fprintf(o, "# bcs\tregistration\tflight\ttext\n");
+        for (const std::string& l : found) {
+            std::fprintf(o, "%s\n", l.c_str());
+        }
+        std::fclose(o);
+        return 0;
+    }
+
+    int differences = 0;
+    for (size_t k = 0; k < std::max(found.size(), expected.size()); k++) {
+        const std::string& e = (k < expected.size()) ? expected[k] : std::string();
+        const std::string& f = (k < found.size()) ? found[k] : std::string();
+        if (e != f) {
+            std::fprintf(stderr, "frame %zu:\n  expected: %s\n  decoded:  %s\n", k + 1,
+                         e.empty() ? "(none)" : e.c_str(), f.empty() ? "(none)" : f.c_str());
+            differences++;
+        }
+    }
+    std::fprintf(stderr, "%zu frames expected, %zu decoded, %d differ\n", expected.size(),
+                 found.size(), differences);
+    return differences ? 1 : 0;
+}
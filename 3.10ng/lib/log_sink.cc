@@ -0,0 +1,43 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "log_sink.h"
+
+namespace gr {
+namespace acars {
+
+file_log_sink::file_log_sink(const std::string& filename) : _dropped(0)
+{
+    // Open output file in append mode
+    _FILE = std::fopen(filename.c_str(), "a");
+    if (!_FILE) {
+        std::perror("Failed to open file in acars_impl");
+    }
+}
+
+file_log_sink::~file_log_sink()
+{
+    if (_FILE) {
+        std::fclose(_FILE);
+        _FILE = nullptr;
+    }
+}
+
+void file_log_sink::write(const char* buf, size_t len)
+{
+    if (!_FILE) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::fwrite(buf, 1, len, _FILE);
+    std::fflush(_FILE);
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_LOG_SINK_H
+#define INCLUDED_ACARS_LOG_SINK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Destination of the decoded message records.
+ *
+ * message_output::parse() formats one complete record per message and hands it to
+ * write() in a single call, so a backend never sees a partial message.
+ */
+class log_sink
+{
+public:
+    virtual ~log_sink() {}
+
+    virtual void write(const char* buf, size_t len) = 0;
+
+    //! Records that could not be written
+    virtual uint64_t dropped() const { return 0; }
+};
+
+/*!
+ * \brief No log: the records only go to the console or the feed.
+ */
+class null_log_sink : public log_sink
+{
+public:
+    void write(const char*, size_t) override {}
+};
+
+/*!
+ * \brief Classic backend: append to a stdio file, flushed after every record.
+ */
+class file_log_sink : public log_sink
+{
+private:
+    FILE* _FILE; ///< output file pointer, nullptr if fopen() failed
+    std::atomic<uint64_t> _dropped;
+
+public:
+    file_log_sink(const std::string& filename);
+    ~file_log_sink() override;
+
+    void write(const char* buf, size_t len) override;
+    uint64_t dropped() const override { return _dropped.load(std::memory_order_relaxed); }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_LOG_SINK_H */
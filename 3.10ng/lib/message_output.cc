@@ -0,0 +1,198 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "message_output.h"
+#include "segment_log.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+#ifdef LIBACARS
+#include <libacars/libacars.h>  // la_proto_node, la_proto_tree_destroy()
+#include <libacars/acars.h>     // la_acars_decode_apps()
+#include <libacars/vstring.h>   // la_vstring, la_vstring_destroy()
+#endif
+
+namespace gr {
+namespace acars {
+
+message_output::message_output(const std::string& filename,
+                               int segment_size,
+                               int rotate_seconds,
+                               float fsync_interval,
+                               const std::string& feed,
+                               float feed_interval,
+                               float dedup_window,
+                               const std::string& dedup_group,
+                               bool console)
+    : _console(console), _duplicates(0)
+{
+    // Either append to filename, or log to memory-mapped segments named
+    // after it, or nowhere without a name
+    if (filename.empty()) {
+        _log.reset(new null_log_sink());
+    } else if (segment_size > 0) {
+        _log.reset(new segment_log(filename, segment_size, rotate_seconds,
+                                   fsync_interval));
+    } else {
+        _log.reset(new file_log_sink(filename));
+    }
+    _record.reserve(4096);
+    if (!feed.empty()) {
+        _feed.reset(new datagram_feed(feed, feed_interval));
+    }
+    if (dedup_window > 0.0f) {
+        _dedup = dedup_cache::get(dedup_group, dedup_window);
+    }
+}
+
+static void append_hex(std::string& r, unsigned char c)
+{
+    static const char hex[] = "0123456789abcdef";
+    r += hex[c >> 4];
+    r += hex[c & 0x0f];
+    r += ' ';
+}
+
+// registration, label, block id, sequence number and text of a message
+static uint64_t message_fingerprint(const char* message, int ends)
+{
+    uint64_t fp = dedup_cache::fingerprint(message + 6, 7);
+    if (ends > 16) {
+        fp = dedup_cache::fingerprint(message + 14, 3, fp);
+    }
+    if (ends > 21) {
+        fp = dedup_cache::fingerprint(message + 18, 4, fp);
+    }
+    int k = 28;
+    while ((k < ends - 1) && (message[k] != 0x03)) {
+        k++;
+    }
+    if (k > 28) {
+        fp = dedup_cache::fingerprint(message + 28, k - 28, fp);
+    }
+    return fp;
+}
+
+bool message_output::synced(const char* message, int ends)
+{
+    return (ends > 4) && (message[0] == 0x2b) && (message[1] == 0x2a) &&
+           (message[2] == 0x16) && (message[3] == 0x16) && (message[4] == 0x01);
+}
+
+// ----------------------------------------------------------------------------
+// parse(): parse an ACARS message
+// ----------------------------------------------------------------------------
+decode_status message_output::parse(const char* message,
+                                    int ends,
+                                    const std::string& channel,
+                                    const struct timespec* when)
+{
+    decode_status status = DECODE_NO_SYNC;
+    // The record is formatted once, then printed on the console and handed
+    // in a single write to the log backend. Only the log gets the date line.
+    _record.clear();
+    if (ends > 12) {
+        if (synced(message, ends))
+        {
+            status = DECODE_OK;
+            if (_dedup) {
+                int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now().time_since_epoch())
+                                  .count();
+                if (_dedup->seen(message_fingerprint(message, ends), now)) {
+                    // already output by this or another block of the group
+                    _duplicates.fetch_add(1, std::memory_order_relaxed);
+                    return status;
+                }
+            }
+            time_t tmv;
+            if (when) {
+                tmv = when->tv_sec;
+            } else {
+                time(&tmv);
+            }
+            char date[32];
+            ctime_r(&tmv, date); // blocks may output concurrently
+            _record += '\n';
+            _record += date;
+            size_t header = _record.size();
+
+            if (!channel.empty()) {
+                _record += "\nChannel=";
+                _record += channel;
+            }
+            _record += "\nAircraft=";
+            for (int k = 6; k < 13; k++) {
+                _record += message[k];
+            }
+            _record += '\n';
+
+            if (ends > 17) {
+                if (message[17] == 0x02) {
+                    _record += "STX\n";
+                }
+                if (ends >= 21) {
+                    _record += "Seq. No=";
+                    for (int k = 18; k < 22; k++) {
+                        append_hex(_record, (unsigned char)message[k]);
+                    }
+                    for (int k = 18; k < 22; k++) {
+                        if ((message[k] >= 32) ||
+                            (message[k] == 0x10) ||
+                            (message[k] == 0x13))
+                        {
+                            _record += message[k];
+                        }
+                    }
+                    _record += '\n';
+                    if (ends >= 27) {
+                        _record += "Flight=";
+                        for (int k = 22; k < 28; k++) {
+                            _record += message[k];
+                        }
+                        _record += '\n';
+                        if (ends >= 28) {
+                            int k = 28;
+                            do {
+                                if (message[k] == 0x03) {
+                                    _record += "ETX";
+                                } else if ((message[k] >= 32) ||
+                                           (message[k] == 0x10) ||
+                                           (message[k] == 0x13))
+                                {
+                                    _record += message[k];
+                                }
+                                k++;
+                            } while ((k < ends - 1) && (message[k - 1] != 0x03));
+                            _record += '\n';
+
+#ifdef LIBACARS
+                            // Example logic for libacars usage
+                            // ...
+#endif
+                        }
+                    }
+                }
+            }
+            if (_console) {
+                std::fwrite(_record.data() + header, 1, _record.size() - header, stdout);
+            }
+            _log->write(_record.data(), _record.size());
+            if (_feed) {
+                _feed->write(_record.data(), _record.size());
+            }
+        }
+    }
+    std::fflush(stdout);
+    return status;
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,95 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_MESSAGE_OUTPUT_H
+#define INCLUDED_ACARS_MESSAGE_OUTPUT_H
+
+#include "burst_dump.h"
+#include "datagram_feed.h"
+#include "dedup_cache.h"
+#include "log_sink.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <time.h>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Output stage of a block: formats the decoded frames and hands them
+ * to the console, the log backend, the optional datagram feed, after the
+ * optional duplicate filter.
+ *
+ * One instance is shared by all the channels of a block; parse() is called
+ * from the thread running the decoders.
+ */
+class message_output
+{
+private:
+    std::unique_ptr<log_sink> _log;       ///< output file backend
+    std::unique_ptr<datagram_feed> _feed; ///< optional datagram output
+    std::shared_ptr<dedup_cache> _dedup;  ///< duplicate filter, may be shared
+    std::string _record;                  ///< formatted message, reused
+    bool _console;                        ///< also print the records on stdout
+    std::atomic<uint64_t> _duplicates;    ///< records stopped by the filter
+
+public:
+    message_output(const std::string& filename,
+                   int segment_size,
+                   int rotate_seconds,
+                   float fsync_interval,
+                   const std::string& feed,
+                   float feed_interval,
+                   float dedup_window,
+                   const std::string& dedup_group,
+                   bool console = true);
+
+    /*!
+     * \brief Check the sync of the \p ends bytes of \p message and output it.
+     *
+     * \p channel, if not empty, is added to the record as a Channel= line.
+     * The record is dated \p when if given, else with the current time.
+     */
+    decode_status parse(const char* message,
+                        int ends,
+                        const std::string& channel,
+                        const struct timespec* when = nullptr);
+
+    //! The record formatted by the last parse(), empty if nothing was output
+    const std::string& record() const { return _record; }
+
+    //! Datagrams the feed could not send
+    uint64_t feed_dropped() const { return _feed ? _feed->dropped() : 0; }
+
+    //! Messages not output, already output by a block of the dedup group
+    uint64_t duplicates() const { return _duplicates.load(std::memory_order_relaxed); }
+
+    //! Records the log backend could not write
+    uint64_t log_dropped() const { return _log->dropped(); }
+
+    //! The frame starts with "+*" SYN SYN SOH
+    static bool synced(const char* message, int ends);
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_MESSAGE_OUTPUT_H */
@@ -0,0 +1,248 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "metrics_server.h"
+#include "channel_decoder.h"
+#include "decode_pool.h"
+#include "message_output.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace gr {
+namespace acars {
+
+// upper bounds of the latency histogram buckets, in seconds
+static const double LE[] = { 1e-5, 3e-5, 1e-4, 3e-4, 1e-3, 3e-3, 0.01,
+                             0.03, 0.1,  0.3,  1.0,  3.0,  10.0 };
+static const int NLE = sizeof(LE) / sizeof(LE[0]);
+
+metrics_server::metrics_server(int port) : _fd(-1), _port(port), _stop(false)
+{
+    _fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (_fd < 0) {
+        throw std::runtime_error(std::string("acars: metrics: socket: ") +
+                                 std::strerror(errno));
+    }
+    int on = 1;
+    setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    struct sockaddr_in a;
+    std::memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(uint16_t(port));
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if ((bind(_fd, reinterpret_cast<struct sockaddr*>(&a), sizeof(a)) < 0) ||
+        (listen(_fd, 8) < 0)) {
+        int e = errno;
+        close(_fd);
+        throw std::runtime_error("acars: metrics: port " + std::to_string(port) + ": " +
+                                 std::strerror(e));
+    }
+    _thread = std::thread(&metrics_server::serve, this);
+}
+
+metrics_server::~metrics_server()
+{
+    _stop.store(true);
+    _thread.join();
+    close(_fd);
+}
+
+std::shared_ptr<metrics_server> metrics_server::get(int port)
+{
+    static std::mutex registry_mutex;
+    static std::weak_ptr<metrics_server> shared;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::shared_ptr<metrics_server> s = shared.lock();
+    if (!s) {
+        s = std::make_shared<metrics_server>(port);
+        shared = s;
+        std::printf("metrics: http://127.0.0.1:%d/metrics\n", port);
+    } else if (port != s->port()) {
+        std::printf("metrics: keeping port %d of the first block\n", s->port());
+    }
+    return s;
+}
+
+void metrics_server::add(const std::string& name,
+                         const channel_decoder* channel,
+                         const decode_pool* pool,
+                         const message_output* out)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _channels.push_back(entry{ name, channel, pool, out });
+}
+
+void metrics_server::remove(const channel_decoder* channel)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _channels.erase(std::remove_if(_channels.begin(),
+                                   _channels.end(),
+                                   [channel](const entry& e) { return e.channel == channel; }),
+                    _channels.end());
+}
+
+// ----------------------------------------------------------------------------
+// serve(): one request per connection, the stop flag checked between them
+// ----------------------------------------------------------------------------
+void metrics_server::serve()
+{
+    while (!_stop.load()) {
+        struct pollfd p = { _fd, POLLIN, 0 };
+        if (poll(&p, 1, 200) <= 0) {
+            continue;
+        }
+        int c = accept4(_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (c >= 0) {
+            answer(c);
+            close(c);
+        }
+    }
+}
+
+void metrics_server::answer(int fd)
+{
+    // the request line is enough; a slow client gets a second
+    struct timeval tv = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    char req[1024];
+    ssize_t n = recv(fd, req, sizeof(req) - 1, 0);
+    if (n <= 0) {
+        return;
+    }
+    req[n] = '\0';
+
+    std::string body, status = "200 OK";
+    if (!std::strncmp(req, "GET /metrics ", 13) || !std::strncmp(req, "GET / ", 6)) {
+        body = metrics();
+    } else {
+        status = "404 Not Found";
+        body = "GET /metrics\n";
+    }
+    std::string r = "HTTP/1.0 " + status +
+                    "\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                    "Content-Length: " +
+                    std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+    for (size_t k = 0; k < r.size();) {
+        ssize_t w = send(fd, r.data() + k, r.size() - k, MSG_NOSIGNAL);
+        if (w <= 0) {
+            return;
+        }
+        k += size_t(w);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// metrics(): the text exposition format
+// ----------------------------------------------------------------------------
+namespace {
+
+void header(std::string& out, const char* name, const char* type, const char* help)
+{
+    out += std::string("# HELP ") + name + " " + help + "\n# TYPE " + name + " " + type +
+           "\n";
+}
+
+void sample(std::string& out, const char* name, const std::string& labels, double v)
+{
+    char s[64];
+    std::snprintf(s, sizeof(s), "%.10g", v);
+    out += std::string(name) + "{" + labels + "} " + s + "\n";
+}
+
+} // namespace
+
+std::string metrics_server::metrics()
+{
+    struct counter {
+        const char* name;
+        const char* type;
+        const char* help;
+    };
+    static const counter counters[] = {
+        { "acars_samples_total", "counter", "Samples through the burst detector." },
+        { "acars_bursts_total", "counter", "Bursts detected." },
+        { "acars_bursts_dropped_total", "counter", "Bursts dropped, decode queue full." },
+        { "acars_frames_total", "counter", "Frames decoded with a valid BCS." },
+        { "acars_sync_failures_total", "counter", "Bursts without the frame start." },
+        { "acars_crc_failures_total", "counter", "Frames failing the BCS check." },
+        { "acars_duplicates_total", "counter",
+          "Messages not output, already output by a block of the dedup group." },
+        { "acars_decode_cpu_seconds_total", "counter", "Decode thread CPU time." },
+        { "acars_queue_depth", "gauge", "Bursts waiting for a decode thread." },
+        { "acars_noise_floor", "gauge", "Standard deviation of the last quiet chunk." },
+    };
+    const int ncounters = sizeof(counters) / sizeof(counters[0]);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    // the values of each channel, in the order of counters
+    std::vector<std::vector<double>> values;
+    for (const entry& e : _channels) {
+        const detector_counters& d = e.channel->detected();
+        const output_counters& o = e.channel->output_counts();
+        values.push_back({ double(d.samples.get()),
+                           double(d.bursts.get()),
+                           double(e.pool->dropped()),
+                           double(o.decoded.get() - o.no_sync.get() - o.bad_crc.get()),
+                           double(o.no_sync.get()),
+                           double(o.bad_crc.get()),
+                           double(e.out->duplicates()),
+                           1e-9 * double(o.cpu_ns.get()),
+                           double(e.pool->queued()),
+                           double(d.noise.load(std::memory_order_relaxed)) });
+    }
+    std::string out;
+    for (int k = 0; k < ncounters; k++) {
+        header(out, counters[k].name, counters[k].type, counters[k].help);
+        for (size_t c = 0; c < _channels.size(); c++) {
+            sample(out, counters[k].name, "channel=\"" + _channels[c].name + "\"",
+                   values[c][k]);
+        }
+    }
+
+#ifdef ACARS_STAGE_TIMING
+    header(out, "acars_stage_seconds", "histogram",
+           "Time of the decoder stages; latency is from detection to output.");
+    for (const entry& e : _channels) {
+        const stage_stats& st = e.channel->stats();
+        for (int s = 0; s < STAGE_COUNT; s++) {
+            uint64_t cumulative[NLE];
+            uint64_t count;
+            double sum;
+            st.histogram(stage(s), LE, NLE, cumulative, sum, count);
+            std::string labels =
+                "channel=\"" + e.name + "\",stage=\"" + stage_stats::name(stage(s)) + "\"";
+            for (int b = 0; b < NLE; b++) {
+                char le[32];
+                std::snprintf(le, sizeof(le), "%g", LE[b]);
+                sample(out, "acars_stage_seconds_bucket", labels + ",le=\"" + le + "\"",
+                       double(cumulative[b]));
+            }
+            sample(out, "acars_stage_seconds_bucket", labels + ",le=\"+Inf\"",
+                   double(count));
+            sample(out, "acars_stage_seconds_sum", labels, sum);
+            sample(out, "acars_stage_seconds_count", labels, double(count));
+        }
+    }
+#endif
+    return out;
+}
+
+} // namespace acars
+} // namespace gr
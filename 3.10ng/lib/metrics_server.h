@@ -0,0 +1,94 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_METRICS_SERVER_H
+#define INCLUDED_ACARS_METRICS_SERVER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+class channel_decoder;
+class decode_pool;
+class message_output;
+
+/*!
+ * \brief Prometheus text-format metrics of the channels, over HTTP on
+ * 127.0.0.1.
+ *
+ * One server per process, shared by the decoders that ask for it like the
+ * executor: the first one sets the port. Its thread answers GET /metrics
+ * with the counters, gauges and latency histograms of the registered
+ * channels, which it reads from their lock-free counters: the sample path
+ * never waits for a scrape. Channels are added and removed under a lock,
+ * when a decoder is made or destroyed.
+ */
+class metrics_server
+{
+private:
+    struct entry {
+        std::string name;
+        const channel_decoder* channel;
+        const decode_pool* pool;
+        const message_output* out;
+    };
+
+    int _fd; ///< listening socket
+    int _port;
+    std::atomic<bool> _stop;
+    std::mutex _mutex; ///< _channels
+    std::vector<entry> _channels;
+    std::thread _thread;
+
+    void serve();
+    void answer(int fd);
+
+public:
+    //! \throws std::runtime_error if the port cannot be bound
+    explicit metrics_server(int port);
+    ~metrics_server();
+
+    metrics_server(const metrics_server&) = delete;
+    metrics_server& operator=(const metrics_server&) = delete;
+
+    //! The server of the process, started on \p port if there is none
+    static std::shared_ptr<metrics_server> get(int port);
+
+    int port() const { return _port; }
+    //! Publish \p channel as channel="name"; until remove()
+    void add(const std::string& name,
+             const channel_decoder* channel,
+             const decode_pool* pool,
+             const message_output* out);
+    void remove(const channel_decoder* channel);
+    //! The page served on /metrics
+    std::string metrics();
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_METRICS_SERVER_H */
@@ -0,0 +1,147 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The polyphase channelizer of acars_multichannel: a burst AM-modulated on
+ * one channel of the input band is decoded on that channel only, whether
+ * above or below the center frequency.
+ */
+
+#include "acars_multichannel_impl.h"
+#include <acars/generator.h>
+#include <boost/test/unit_test.hpp>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+const double RATE = 1200000; // 48 channels of 25 kHz, 25 times 48 kHz
+const double SPACING = 25000;
+const double CENTER = 131525000;
+
+// One burst on a channel: the envelope of the generator, AM-modulated on
+// the carrier of the channel
+struct transmission {
+    acars_message message;
+    int channel; ///< in channels of the center frequency
+};
+
+std::vector<gr_complex> band(const std::vector<transmission>& tx)
+{
+    generator::config gc;
+    gc.samp_rate = RATE;
+    gc.snr_db = 40.0f;
+    gc.align = int(RATE / 48000) * channel_decoder::CHUNK; // a decoder chunk
+    generator g(gc);
+    std::vector<size_t> ends;
+    for (const auto& t : tx) {
+        g.add(t.message);
+        ends.push_back(g.samples().size());
+    }
+    g.add_noise(0.5);
+    const std::vector<float>& a = g.samples();
+
+    // each carrier keyed from the end of the previous burst to the end of
+    // its own, under a little noise on the whole band
+    std::vector<gr_complex> x(a.size());
+    unsigned seed = 1;
+    size_t k = 0;
+    for (size_t t = 0; t < x.size(); t++) {
+        seed = seed * 1103515245u + 12345u;
+        float n = 0.01f * (float((seed >> 16) & 0x7fff) / 16384.0f - 1.0f);
+        x[t] = gr_complex(n, -n);
+        while ((k < ends.size()) && (t >= ends[k])) {
+            k++;
+        }
+        if (k < ends.size()) {
+            double w = 2.0 * M_PI * tx[k].channel * SPACING / RATE;
+            x[t] += (0.5f + a[t]) * std::polar(1.0f, float(std::fmod(w * t, 2.0 * M_PI)));
+        }
+    }
+    return x;
+}
+
+//! The log of \p channels (in channels of the center) decoding \p x
+std::string decode(const std::vector<gr_complex>& x, const std::vector<int>& channels)
+{
+    const std::string log = "/tmp/acars_qa_multichannel_" + std::to_string(getpid());
+    unlink(log.c_str());
+    {
+        std::vector<double> freqs;
+        for (int c : channels) {
+            freqs.push_back(CENTER + c * SPACING);
+        }
+        acars_multichannel_impl b(3.0f, RATE, CENTER, freqs, log, false, SPACING, "",
+                                  0.0f, "acars", 0, 16);
+
+        // as the scheduler would: whole decimation periods, after the history
+        const int D = int(RATE / 48000);
+        std::vector<gr_complex> in(b.history() - 1, gr_complex(0.0f, 0.0f));
+        in.insert(in.end(), x.begin(), x.end());
+        gr_vector_const_void_star inputs(1);
+        gr_vector_void_star outputs;
+        const size_t step = 4096 * D;
+        for (size_t k = 0; k + D <= x.size(); k += step) {
+            int n = int(std::min(step, (x.size() - k) / D * D));
+            inputs[0] = &in[k];
+            b.work(n, inputs, outputs);
+        }
+    }
+    std::ifstream f(log);
+    std::ostringstream s;
+    s << f.rdbuf();
+    unlink(log.c_str());
+    return s.str();
+}
+
+size_t count(const std::string& s, const std::string& what)
+{
+    size_t n = 0;
+    for (size_t k = s.find(what); k != std::string::npos; k = s.find(what, k + 1)) {
+        n++;
+    }
+    return n;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(burst_on_its_channel_only)
+{
+    transmission up, down;
+    up.message.text = "ON CHANNEL PLUS ONE";
+    up.channel = 1;
+    down.message.msn = "M02A";
+    down.message.text = "ON CHANNEL MINUS TWO";
+    down.channel = -2;
+    std::string log = decode(band({ up, down }), { -2, -1, 0, 1, 2 });
+
+    BOOST_CHECK_EQUAL(count(log, "Aircraft="), 2u);
+    BOOST_CHECK_EQUAL(count(log, "Channel=131.550"), 1u);
+    BOOST_CHECK_EQUAL(count(log, "Channel=131.475"), 1u);
+    BOOST_CHECK_EQUAL(count(log, "ON CHANNEL PLUS ONE"), 1u);
+    BOOST_CHECK_EQUAL(count(log, "ON CHANNEL MINUS TWO"), 1u);
+    // in the right order: each text under the channel it was sent on
+    size_t plus = log.find("Channel=131.550");
+    size_t minus = log.find("Channel=131.475");
+    BOOST_CHECK(plus < log.find("ON CHANNEL PLUS ONE"));
+    BOOST_CHECK(log.find("ON CHANNEL PLUS ONE") < minus);
+    BOOST_CHECK(minus < log.find("ON CHANNEL MINUS TWO"));
+}
+
+BOOST_AUTO_TEST_CASE(nothing_off_channel)
+{
+    // the same burst, listened to everywhere but on its channel
+    transmission t;
+    t.channel = 1;
+    std::string log = decode(band({ t }), { -1, 0, 2, 3 });
+    BOOST_CHECK_EQUAL(count(log, "Aircraft="), 0u);
+}
@@ -0,0 +1,190 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The steady state of the decoder does not allocate: once it has seen the
+ * bursts of a signal, pushing the same signal again, detection, decoding on
+ * the caller's thread or on the executor, and output, makes no call to
+ * malloc in any thread. The test counts the calls by replacing malloc and
+ * its siblings with wrappers of the glibc functions; elsewhere, or under a
+ * sanitizer, which brings its own allocator, it only decodes.
+ */
+
+#include <acars/demod.h>
+#include <acars/generator.h>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || \
+    __has_feature(memory_sanitizer)
+#define ACARS_SANITIZER
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define ACARS_SANITIZER
+#endif
+
+#if defined(__GLIBC__) && !defined(ACARS_SANITIZER)
+#define ACARS_COUNT_MALLOC
+#endif
+
+using namespace gr::acars;
+
+namespace {
+
+std::atomic<bool> counting(false);
+std::atomic<uint64_t> allocations(0);
+
+inline void count()
+{
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+#ifdef ACARS_COUNT_MALLOC
+extern "C" {
+void* __libc_malloc(size_t n);
+void* __libc_calloc(size_t count, size_t n);
+void* __libc_realloc(void* p, size_t n);
+void* __libc_memalign(size_t alignment, size_t n);
+
+void* malloc(size_t n)
+{
+    count();
+    return __libc_malloc(n);
+}
+
+void* calloc(size_t c, size_t n)
+{
+    count();
+    return __libc_calloc(c, n);
+}
+
+void* realloc(void* p, size_t n)
+{
+    count();
+    return __libc_realloc(p, n);
+}
+
+void* memalign(size_t alignment, size_t n)
+{
+    count();
+    return __libc_memalign(alignment, n);
+}
+
+void* aligned_alloc(size_t alignment, size_t n)
+{
+    count();
+    return __libc_memalign(alignment, n);
+}
+
+int posix_memalign(void** p, size_t alignment, size_t n)
+{
+    count();
+    void* q = __libc_memalign(alignment, n);
+    if (!q) {
+        return ENOMEM;
+    }
+    *p = q;
+    return 0;
+}
+}
+#endif
+
+namespace {
+
+// Frames of 0 to 220 characters between gaps of noise of various lengths
+std::vector<float> traffic(double rate)
+{
+    generator::config gc;
+    gc.samp_rate = rate;
+    gc.snr_db = 25.0f;
+    generator g(gc);
+    for (int k = 0; k < 8; k++) {
+        acars_message m;
+        m.msn[3] = char('A' + k);
+        m.text = std::string(size_t(k * 30), char('A' + k));
+        g.add(m);
+        g.add_noise(0.1 * k);
+    }
+    g.add_noise(0.5);
+    return g.samples();
+}
+
+// Push the samples in pieces of an odd size, then end the stream
+template <typename T>
+void run(demod& d, const std::vector<T>& s)
+{
+    const size_t piece = 4093;
+    for (size_t k = 0; k < s.size(); k += piece) {
+        d.push(s.data() + k, std::min(piece, s.size() - k));
+    }
+    d.flush();
+}
+
+uint64_t valid_frames(const demod& d)
+{
+    demod_stats st = d.stats();
+    return st.bursts_decoded - st.sync_failures - st.crc_failures;
+}
+
+// Allocations of the third run of \p s, after two to warm up
+template <typename T>
+uint64_t steady_allocations(demod::config cfg, const std::vector<T>& s)
+{
+    cfg.max_pending = 0; // pull() copies the messages
+    demod d(cfg);
+    run(d, s);
+    run(d, s);
+    uint64_t decoded = d.decoded();
+    uint64_t frames = valid_frames(d);
+
+    allocations.store(0);
+    counting.store(true);
+    run(d, s);
+    counting.store(false);
+    uint64_t n = allocations.load();
+
+    // the same bursts and frames as in the other runs
+    BOOST_CHECK(frames > 0);
+    BOOST_CHECK_EQUAL(d.decoded(), 3 * decoded / 2);
+    BOOST_CHECK_EQUAL(valid_frames(d), 3 * frames / 2);
+    return n;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(float_inline)
+{
+    std::vector<float> s = traffic(48000);
+    demod::config cfg;
+    cfg.decode_threads = 0;
+    BOOST_CHECK_EQUAL(steady_allocations(cfg, s), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(short_threads)
+{
+    std::vector<float> f = traffic(24000);
+    std::vector<int16_t> s(f.size());
+    for (size_t k = 0; k < f.size(); k++) {
+        s[k] = int16_t(std::max(-1.0f, std::min(1.0f, f[k])) * 32767.0f);
+    }
+    demod::config cfg;
+    cfg.input = demod::INPUT_SHORT;
+    cfg.samp_rate = 24000;
+    cfg.decode_threads = 2;
+    BOOST_CHECK_EQUAL(steady_allocations(cfg, s), 0u);
+}
@@ -0,0 +1,104 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The AM front end of complex input: the envelope of a carrier modulated
+ * by a tone comes out at the decimated rate, with the carrier level (the
+ * DC of the envelope) removed, whatever the sizes of the calls.
+ */
+
+#include "am_frontend.h"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+const int DECIM = 4;
+const double OUT_RATE = 48000;
+
+//! \p seconds of a carrier of level \p carrier, off by 3 kHz from the
+//! channel center and AM-modulated by a \p tone Hz tone of level 0.2
+std::vector<std::complex<float>> am(double seconds, float carrier, double tone)
+{
+    const double rate = OUT_RATE * DECIM;
+    std::vector<std::complex<float>> x(size_t(seconds * rate));
+    for (size_t t = 0; t < x.size(); t++) {
+        float envelope = carrier + 0.2f * float(std::cos(2.0 * M_PI * tone * t / rate));
+        x[t] = std::polar(envelope, float(std::fmod(2.0 * M_PI * 3000.0 * t / rate,
+                                                    2.0 * M_PI)));
+    }
+    return x;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(decimated_tone_without_dc)
+{
+    std::vector<std::complex<float>> x = am(1.0, 0.8f, 1200.0);
+    const int nout = int(x.size() / DECIM);
+    BOOST_REQUIRE_EQUAL(nout, int(OUT_RATE));
+    std::vector<float> y(nout);
+    am_frontend f(DECIM, OUT_RATE);
+    f.process(x.data(), nout, y.data());
+
+    // past the settling of the DC blocker (30 Hz, 5 ms): no carrier left,
+    // and the tone at its level and at 1200 Hz of the output rate
+    double mean = 0.0, i = 0.0, q = 0.0;
+    const int settled = nout / 4;
+    for (int n = settled; n < nout; n++) {
+        mean += y[n];
+        i += y[n] * std::cos(2.0 * M_PI * 1200.0 * n / OUT_RATE);
+        q += y[n] * std::sin(2.0 * M_PI * 1200.0 * n / OUT_RATE);
+    }
+    const int m = nout - settled;
+    BOOST_CHECK_SMALL(mean / m, 0.005);
+    BOOST_CHECK_CLOSE(2.0 * std::hypot(i, q) / m, 0.2, 3.0);
+
+    // the same tone seen at the input rate instead would be elsewhere
+    double i4 = 0.0, q4 = 0.0;
+    for (int n = settled; n < nout; n++) {
+        i4 += y[n] * std::cos(2.0 * M_PI * 1200.0 * n / (OUT_RATE * DECIM));
+        q4 += y[n] * std::sin(2.0 * M_PI * 1200.0 * n / (OUT_RATE * DECIM));
+    }
+    BOOST_CHECK_LT(2.0 * std::hypot(i4, q4) / m, 0.02);
+}
+
+BOOST_AUTO_TEST_CASE(carrier_alone_decays)
+{
+    // an unmodulated carrier: the output starts at the carrier level and
+    // decays to nothing
+    std::vector<std::complex<float>> x(size_t(0.5 * OUT_RATE) * DECIM,
+                                       std::polar(0.8f, 1.0f));
+    std::vector<float> y(x.size() / DECIM);
+    am_frontend f(DECIM, OUT_RATE);
+    f.process(x.data(), int(y.size()), y.data());
+    BOOST_CHECK_CLOSE(y[0], 0.8f, 0.1);
+    BOOST_CHECK_SMALL(y[y.size() - 1], 1e-4f);
+}
+
+BOOST_AUTO_TEST_CASE(any_call_size)
+{
+    std::vector<std::complex<float>> x = am(0.1, 0.8f, 1200.0);
+    const int nout = int(x.size() / DECIM);
+    std::vector<float> whole(nout), parts(nout);
+    am_frontend a(DECIM, OUT_RATE);
+    a.process(x.data(), nout, whole.data());
+
+    am_frontend b(DECIM, OUT_RATE);
+    const int sizes[] = { 1, 7, 64, 65, 200 };
+    for (int n = 0, k = 0; n < nout; k++) {
+        int m = std::min(sizes[k % 5], nout - n);
+        b.process(&x[size_t(n) * DECIM], m, &parts[n]);
+        n += m;
+    }
+    for (int n = 0; n < nout; n++) {
+        BOOST_REQUIRE_EQUAL(whole[n], parts[n]);
+    }
+}
@@ -0,0 +1,289 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The capture of the bursts in SigMF: the policy picks the bursts written
+ * for a stream holding one corrupted frame, the metadata describes the
+ * recordings, and the ring drops bursts rather than wait for its writer.
+ */
+
+#include "burst_dump.h"
+#include <acars/demod.h>
+#include <acars/generator.h>
+#include <boost/test/unit_test.hpp>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+// A fresh directory, removed with its files
+struct temp_dir {
+    std::string path;
+
+    temp_dir()
+    {
+        char p[] = "/tmp/acars_qa_dump_XXXXXX";
+        BOOST_REQUIRE(mkdtemp(p) != nullptr);
+        path = p;
+    }
+    ~temp_dir()
+    {
+        for (const auto& f : files("")) {
+            unlink((path + "/" + f).c_str());
+        }
+        rmdir(path.c_str());
+    }
+
+    //! The names of the files ending with \p suffix, sorted
+    std::vector<std::string> files(const std::string& suffix) const
+    {
+        std::vector<std::string> v;
+        DIR* d = opendir(path.c_str());
+        if (d == nullptr) {
+            return v;
+        }
+        while (struct dirent* e = readdir(d)) {
+            std::string n = e->d_name;
+            if ((n[0] != '.') && (n.size() > suffix.size()) &&
+                (n.compare(n.size() - suffix.size(), suffix.size(), suffix) == 0)) {
+                v.push_back(n);
+            }
+        }
+        closedir(d);
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+};
+
+std::string contents(const std::string& path)
+{
+    std::ifstream in(path);
+    std::ostringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+off_t size_of(const std::string& path)
+{
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? st.st_size : -1;
+}
+
+//! The stream offset in the name acars<tag>_<date>_<time>_<offset>_raw...
+uint64_t offset_of(const std::string& name)
+{
+    size_t end = name.rfind('_');
+    size_t start = name.rfind('_', end - 1) + 1;
+    return std::strtoull(name.substr(start, end - start).c_str(), nullptr, 10);
+}
+
+//! The value of "key": in a metadata file, quotes removed
+std::string meta(const std::string& m, const std::string& key)
+{
+    size_t k = m.find("\"" + key + "\": ");
+    if (k == std::string::npos) {
+        return "";
+    }
+    k += key.size() + 4;
+    size_t end = m.find_first_of(",\n", k);
+    std::string v = m.substr(k, end - k);
+    v.erase(std::remove(v.begin(), v.end(), '"'), v.end());
+    return v;
+}
+
+// Four frames, the second one with two bits of its text inverted: the
+// parity holds, the BCS does not
+struct stream {
+    std::vector<float> samples;
+    std::vector<uint64_t> starts; ///< of the bursts
+    size_t multiple;
+
+    stream()
+    {
+        demod::config cfg;
+        multiple = demod(cfg).input_multiple();
+        generator::config gc;
+        gc.snr_db = 40.0f;
+        gc.align = int(multiple);
+        generator g(gc);
+        for (int k = 0; k < 4; k++) {
+            acars_message m;
+            m.msn[3] = char('A' + k);
+            std::vector<unsigned char> f = generator::frame(m);
+            if (k == 1) {
+                auto w = std::find_if(f.begin(), f.end(), [](unsigned char c) {
+                    return (c & 0x7f) == 'W';
+                });
+                *w ^= 0x03;
+            }
+            starts.push_back(g.add(f));
+        }
+        g.add_noise(0.5);
+        samples = g.samples();
+    }
+};
+
+//! Decode the stream with the capture in \p dir
+void decode(const stream& s, const std::string& dir, bool failed, int sample)
+{
+    demod::config cfg;
+    cfg.saveall = true;
+    cfg.sigmf = true;
+    cfg.capture_failed = failed;
+    cfg.capture_sample = sample;
+    cfg.capture_dir = dir;
+    cfg.capture_tag = "qa";
+    demod d(cfg);
+    d.push(s.samples.data(), s.samples.size());
+    d.flush();
+    BOOST_CHECK_EQUAL(d.decoded(), 4u);
+} // the writer has written everything when the demod is gone
+
+//! The burst, 0 to 3, starting near \p offset
+int burst_at(const stream& s, uint64_t offset)
+{
+    auto next = std::upper_bound(s.starts.begin(), s.starts.end(), offset + s.multiple);
+    return int(next - s.starts.begin()) - 1;
+}
+
+//! The bursts recorded in \p dir, with the decode result of each
+std::vector<std::pair<int, std::string>> recorded(const stream& s, const temp_dir& dir)
+{
+    std::vector<std::pair<int, std::string>> v;
+    for (const auto& n : dir.files("_raw.sigmf-meta")) {
+        std::string m = contents(dir.path + "/" + n);
+        v.push_back(std::make_pair(burst_at(s, offset_of(n)), meta(m, "core:label")));
+    }
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(capture_all)
+{
+    stream s;
+    temp_dir dir;
+    decode(s, dir.path, false, 0);
+    auto v = recorded(s, dir);
+    BOOST_REQUIRE_EQUAL(v.size(), 4u);
+    for (int k = 0; k < 4; k++) {
+        BOOST_CHECK_EQUAL(v[k].first, k);
+        BOOST_CHECK_EQUAL(v[k].second, (k == 1) ? "bad-crc" : "ok");
+    }
+    BOOST_CHECK_EQUAL(dir.files("_raw.sigmf-data").size(), 4u);
+    BOOST_CHECK_EQUAL(dir.files("_tones.sigmf-data").size(), 4u);
+    BOOST_CHECK_EQUAL(dir.files("_tones.sigmf-meta").size(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(capture_failed)
+{
+    stream s;
+    {
+        // the corrupted frame only
+        temp_dir dir;
+        decode(s, dir.path, true, 0);
+        auto v = recorded(s, dir);
+        BOOST_REQUIRE_EQUAL(v.size(), 1u);
+        BOOST_CHECK_EQUAL(v[0].first, 1);
+        BOOST_CHECK_EQUAL(v[0].second, "bad-crc");
+        BOOST_CHECK_EQUAL(dir.files(".sigmf-data").size(), 2u);
+    }
+    {
+        // and one good frame out of two: the second one, frame 2
+        temp_dir dir;
+        decode(s, dir.path, true, 2);
+        auto v = recorded(s, dir);
+        BOOST_REQUIRE_EQUAL(v.size(), 2u);
+        BOOST_CHECK_EQUAL(v[0].first, 1);
+        BOOST_CHECK_EQUAL(v[0].second, "bad-crc");
+        BOOST_CHECK_EQUAL(v[1].first, 2);
+        BOOST_CHECK_EQUAL(v[1].second, "ok");
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sigmf_metadata)
+{
+    stream s;
+    temp_dir dir;
+    decode(s, dir.path, true, 0);
+    std::vector<std::string> raw = dir.files("_raw.sigmf-meta");
+    std::vector<std::string> tones = dir.files("_tones.sigmf-meta");
+    BOOST_REQUIRE_EQUAL(raw.size(), 1u);
+    BOOST_REQUIRE_EQUAL(tones.size(), 1u);
+    BOOST_CHECK_EQUAL(raw[0].compare(0, 7, "acarsqa"), 0);
+
+    std::string base = dir.path + "/" + raw[0].substr(0, raw[0].size() - 11);
+    std::string m = contents(base + ".sigmf-meta");
+    BOOST_CHECK_EQUAL(meta(m, "core:datatype"), "rf32_le");
+    BOOST_CHECK_EQUAL(meta(m, "core:sample_rate"), "48000.0");
+    BOOST_CHECK_EQUAL(meta(m, "core:num_channels"), "1");
+    BOOST_CHECK_EQUAL(meta(m, "core:version"), "1.0.0");
+    BOOST_CHECK_EQUAL(meta(m, "core:global_index"), std::to_string(offset_of(raw[0])));
+    BOOST_CHECK_EQUAL(meta(m, "core:label"), "bad-crc");
+    BOOST_CHECK_GT(std::atoi(meta(m, "acars:bytes").c_str()), 0);
+    const off_t count = size_of(base + ".sigmf-data") / off_t(sizeof(float));
+    BOOST_CHECK_GT(count, 0);
+    BOOST_CHECK_EQUAL(meta(m, "core:sample_count"), std::to_string(count));
+    struct tm tmv = {};
+    BOOST_CHECK(strptime(meta(m, "core:datetime").c_str(), "%Y-%m-%dT%H:%M:%S", &tmv));
+
+    // the tones: two complex channels of the same length as the samples
+    base = dir.path + "/" + tones[0].substr(0, tones[0].size() - 11);
+    m = contents(base + ".sigmf-meta");
+    BOOST_CHECK_EQUAL(meta(m, "core:datatype"), "cf32_le");
+    BOOST_CHECK_EQUAL(meta(m, "core:num_channels"), "2");
+    BOOST_CHECK_EQUAL(meta(m, "core:sample_count"), std::to_string(count));
+    BOOST_CHECK_EQUAL(size_of(base + ".sigmf-data"), off_t(count * 2 * 8));
+}
+
+BOOST_AUTO_TEST_CASE(writer_behind)
+{
+    // bursts committed faster than the writer can write them, into a ring
+    // of two slots
+    temp_dir dir;
+    const int n = 200;
+    uint64_t dropped, committed = 0;
+    {
+        burst_dump dump(burst_dump::SIGMF, burst_dump::CAPTURE_ALL, 0, 48000.0,
+                        dir.path, "qa", 2);
+        for (int k = 0; k < n; k++) {
+            burst_record* b = dump.acquire();
+            if (b == nullptr) {
+                continue;
+            }
+            b->raw.assign(4800, 0.1f);
+            b->tones.assign(2 * 4800, std::complex<float>(0.1f, 0.0f));
+            b->sample_offset = uint64_t(k) * 48000;
+            clock_gettime(CLOCK_REALTIME, &b->start);
+            b->status = DECODE_OK;
+            b->nbytes = 20;
+            dump.commit(b);
+            committed = b->sample_offset;
+        }
+        dropped = dump.dropped();
+        BOOST_CHECK_GT(dropped, 0u);
+    }
+
+    // the bursts still in the ring are written at the end, the last one
+    // committed included
+    std::vector<std::string> raw = dir.files("_raw.sigmf-data");
+    BOOST_CHECK_EQUAL(raw.size() + dropped, uint64_t(n));
+    uint64_t last = 0;
+    for (const auto& r : raw) {
+        last = std::max(last, offset_of(r));
+    }
+    BOOST_CHECK_EQUAL(last, committed);
+}
@@ -0,0 +1,139 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The datagram feed to an AF_UNIX socket: records are held for the flush
+ * interval and then sent together, one datagram each, a full batch goes at
+ * once, and records with no listener are counted as dropped.
+ */
+
+#include "datagram_feed.h"
+#include <boost/test/unit_test.hpp>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+// A datagram socket bound to a fresh path, the aggregator of the tests
+struct listener {
+    std::string path;
+    int fd;
+
+    explicit listener(const char* test)
+        : path("/tmp/acars_qa_" + std::string(test) + "_" + std::to_string(getpid()))
+    {
+        unlink(path.c_str());
+        fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_un a;
+        std::memset(&a, 0, sizeof(a));
+        a.sun_family = AF_UNIX;
+        std::strncpy(a.sun_path, path.c_str(), sizeof(a.sun_path) - 1);
+        BOOST_REQUIRE(bind(fd, reinterpret_cast<struct sockaddr*>(&a), sizeof(a)) == 0);
+    }
+    ~listener()
+    {
+        close(fd);
+        unlink(path.c_str());
+    }
+
+    //! The next datagram, waiting up to \p timeout_ms; false if none came
+    bool receive(std::string& d, int timeout_ms)
+    {
+        struct pollfd p = { fd, POLLIN, 0 };
+        if (poll(&p, 1, timeout_ms) <= 0) {
+            return false;
+        }
+        char buf[4096];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            return false;
+        }
+        d.assign(buf, size_t(n));
+        return true;
+    }
+};
+
+void write(datagram_feed& f, const std::string& r) { f.write(r.data(), r.size()); }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(records_are_batched)
+{
+    listener l("batched");
+    datagram_feed f("unix:" + l.path, 0.2f);
+    auto t0 = std::chrono::steady_clock::now();
+    write(f, "\nAircraft=.N12345\nFIRST\n");
+    write(f, "\nAircraft=.N12345\nSECOND\n");
+    write(f, std::string(3000, 'x'));
+
+    // nothing before the end of the flush interval, then the three records
+    std::string d;
+    BOOST_CHECK(!l.receive(d, 50));
+    BOOST_REQUIRE(l.receive(d, 2000));
+    double waited =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    BOOST_CHECK_GE(waited, 0.15);
+    BOOST_CHECK_EQUAL(d, "\nAircraft=.N12345\nFIRST\n");
+    BOOST_REQUIRE(l.receive(d, 100));
+    BOOST_CHECK_EQUAL(d, "\nAircraft=.N12345\nSECOND\n");
+    BOOST_REQUIRE(l.receive(d, 100));
+    BOOST_CHECK_EQUAL(d, std::string(datagram_feed::MAX_RECORD, 'x')); // truncated
+    BOOST_CHECK(!l.receive(d, 50));
+    BOOST_CHECK_EQUAL(f.sent(), 3u);
+    BOOST_CHECK_EQUAL(f.dropped(), 0u);
+
+    // the next record starts a new interval
+    write(f, "THIRD");
+    BOOST_CHECK(!l.receive(d, 50));
+    BOOST_REQUIRE(l.receive(d, 2000));
+    BOOST_CHECK_EQUAL(d, "THIRD");
+}
+
+BOOST_AUTO_TEST_CASE(full_batch_goes_at_once)
+{
+    listener l("full");
+    datagram_feed f("unix:" + l.path, 60.0f);
+    for (int k = 0; k < datagram_feed::MAX_BATCH; k++) {
+        write(f, "record " + std::to_string(k));
+    }
+    // long before the flush interval; the socket queue of the listener may
+    // not hold them all, the others are counted as dropped
+    std::string d;
+    BOOST_REQUIRE(l.receive(d, 2000));
+    BOOST_CHECK_EQUAL(d, "record 0");
+    uint64_t received = 1;
+    while (l.receive(d, 100)) {
+        BOOST_CHECK_EQUAL(d, "record " + std::to_string(received));
+        received++;
+    }
+    BOOST_CHECK_EQUAL(f.sent(), received);
+    BOOST_CHECK_EQUAL(f.sent() + f.dropped(), uint64_t(datagram_feed::MAX_BATCH));
+}
+
+BOOST_AUTO_TEST_CASE(unbatched_and_no_listener)
+{
+    listener l("unbatched");
+    {
+        datagram_feed f("unix:" + l.path, 0.0f);
+        write(f, "NOW");
+        std::string d;
+        BOOST_REQUIRE(l.receive(d, 0));
+        BOOST_CHECK_EQUAL(d, "NOW");
+    }
+
+    datagram_feed f("unix:" + l.path + ".none", 0.0f);
+    write(f, "LOST");
+    BOOST_CHECK_EQUAL(f.sent(), 0u);
+    BOOST_CHECK_EQUAL(f.dropped(), 1u);
+    BOOST_CHECK_THROW(datagram_feed("tcp:host:1", 0.0f), std::invalid_argument);
+}
@@ -0,0 +1,85 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The duplicate filter: a message is a duplicate within its window only,
+ * the oldest entry gives way when the probed slots are all live, and the
+ * blocks of a group share one cache.
+ */
+
+#include "dedup_cache.h"
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <memory>
+
+using namespace gr::acars;
+
+namespace {
+
+const int64_t S = 1000000000; // ns
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(window_expiry)
+{
+    dedup_cache c(1.0f);
+    const uint64_t fp = dedup_cache::fingerprint("HELLO", 5);
+    BOOST_CHECK(!c.seen(fp, 0));
+    BOOST_CHECK(c.seen(fp, S / 2));
+    BOOST_CHECK(!c.seen(dedup_cache::fingerprint("HELLO!", 6), S / 2));
+    // the window runs from the first sighting, not the last
+    BOOST_CHECK(c.seen(fp, S));
+    BOOST_CHECK(!c.seen(fp, S + S / 10));
+    BOOST_CHECK(c.seen(fp, 2 * S));
+
+    BOOST_CHECK_EQUAL(c.lookups(), 6u);
+    BOOST_CHECK_EQUAL(c.hits(), 3u);
+    BOOST_CHECK_CLOSE(c.hit_rate(), 0.5, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(eviction_when_full)
+{
+    // 64 slots; fingerprints 64 apart all start probing at the same slot
+    dedup_cache c(1000.0f, 64);
+    const int probe = 32;
+    for (int k = 0; k <= probe; k++) {
+        BOOST_CHECK(!c.seen(uint64_t(5 + 64 * k), k));
+    }
+    // the last one took the slot of the oldest, the others are still there
+    BOOST_CHECK(c.seen(uint64_t(5 + 64 * probe), 100));
+    for (int k = 2; k < probe; k++) {
+        BOOST_CHECK(c.seen(uint64_t(5 + 64 * k), 100));
+    }
+    BOOST_CHECK(c.seen(uint64_t(5 + 64 * 1), 100));
+    BOOST_CHECK(!c.seen(uint64_t(5), 100));
+    // which in turn took the place of the next oldest
+    BOOST_CHECK(!c.seen(uint64_t(5 + 64 * 1), 101));
+
+    // a fingerprint elsewhere in the table is not affected
+    BOOST_CHECK(!c.seen(uint64_t(40 + 64), 102));
+    BOOST_CHECK(c.seen(uint64_t(40 + 64), 103));
+}
+
+BOOST_AUTO_TEST_CASE(shared_by_group)
+{
+    std::shared_ptr<dedup_cache> a = dedup_cache::get("qa_group", 1.0f);
+    std::shared_ptr<dedup_cache> b = dedup_cache::get("qa_group", 2.0f);
+    std::shared_ptr<dedup_cache> other = dedup_cache::get("qa_other", 1.0f);
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(a != other);
+
+    const uint64_t fp = dedup_cache::fingerprint("MSG", 3);
+    BOOST_CHECK(!a->seen(fp, 0));
+    BOOST_CHECK(b->seen(fp, S / 2));
+    BOOST_CHECK(!other->seen(fp, S / 2));
+    // the window of the first block is kept
+    BOOST_CHECK(!b->seen(fp, S + S / 2));
+
+    // a group no block uses any more starts afresh
+    a.reset();
+    b.reset();
+    std::shared_ptr<dedup_cache> c = dedup_cache::get("qa_group", 1.0f);
+    BOOST_CHECK(!c->seen(fp, 2 * S));
+}
@@ -0,0 +1,325 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The push / pull interface of libacarsdemod: the detector sees the same
+ * chunks whatever the sizes of the pushes, flush() ends the stream, and the
+ * configuration is checked.
+ */
+
+#include <acars/demod.h>
+#include <acars/generator.h>
+#include "qa_signals.h"
+#include <arpa/inet.h>
+#include <boost/test/unit_test.hpp>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gr::acars;
+using namespace gr::acars::qa;
+
+namespace {
+
+// The answer to a GET of \p path on 127.0.0.1:port, empty on failure
+std::string http_get(int port, const char* path)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a;
+    std::memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(uint16_t(port));
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    std::string answer;
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&a), sizeof(a)) == 0) {
+        std::string request = std::string("GET ") + path + " HTTP/1.0\r\n\r\n";
+        if (write(fd, request.data(), request.size()) == ssize_t(request.size())) {
+            char buf[4096];
+            ssize_t n;
+            while ((n = read(fd, buf, sizeof(buf))) > 0) {
+                answer.append(buf, size_t(n));
+            }
+        }
+    }
+    close(fd);
+    return answer;
+}
+
+//! \p n frames numbered in their sequence number, bursts starting on a
+//! multiple of \p align samples
+std::vector<float> frames(int n, size_t align)
+{
+    generator::config gc;
+    gc.snr_db = 40.0f;
+    gc.align = int(align);
+    generator g(gc);
+    for (int k = 0; k < n; k++) {
+        acars_message m;
+        m.msn = "M" + std::to_string(100 + k);
+        g.add(m);
+    }
+    g.add_noise(0.5);
+    return g.samples();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(any_push_size)
+{
+    std::vector<float> s = keyed_signal(6);
+    demod::config cfg;
+    demod d(cfg);
+    BOOST_CHECK_EQUAL(d.rate(), 48000);
+    const size_t chunk = d.input_multiple();
+
+    uint64_t n = bursts(s, chunk, false);
+    BOOST_CHECK_EQUAL(n, 6u);
+    BOOST_CHECK_EQUAL(bursts(s, 1, false), n);
+    BOOST_CHECK_EQUAL(bursts(s, 777, false), n);
+    BOOST_CHECK_EQUAL(bursts(s, 10 * chunk + 3, false), n);
+}
+
+BOOST_AUTO_TEST_CASE(flush_ends_the_stream)
+{
+    // the stream stops in the middle of the 4th burst
+    std::vector<float> s = keyed_signal(3.5);
+    BOOST_CHECK_EQUAL(bursts(s, 4096, false), 3u);
+    BOOST_CHECK_EQUAL(bursts(s, 4096, true), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(flush_keeps_the_offsets)
+{
+    demod::config cfg;
+    demod d(cfg);
+    generator::config gc;
+    gc.snr_db = 40.0f;
+    gc.align = int(d.input_multiple());
+    generator g(gc);
+    g.add(acars_message());
+    std::vector<float> s = g.samples();
+
+    // the stream ends with the burst: flush() adds quiet chunks, which are
+    // part of the stream
+    demod_message first, second;
+    d.push(s.data(), s.size());
+    d.flush();
+    const uint64_t samples = d.stats().samples;
+    BOOST_REQUIRE(d.pull(first));
+    d.push(s.data(), s.size());
+    d.flush();
+    BOOST_REQUIRE(d.pull(second));
+    BOOST_CHECK(samples > s.size());
+    BOOST_CHECK_EQUAL(second.offset - first.offset, samples);
+}
+
+BOOST_AUTO_TEST_CASE(duplicates)
+{
+    demod::config cfg;
+    cfg.dedup_window = 60.0f;
+    cfg.dedup_group = "qa_duplicates";
+    demod d1(cfg), d2(cfg);
+    generator::config gc;
+    gc.snr_db = 40.0f;
+    gc.align = int(d1.input_multiple());
+    generator g(gc);
+    for (int k = 0; k < 3; k++) {
+        acars_message m;
+        m.msn[3] = char('A' + k);
+        g.add(m);
+    }
+    g.add_noise(0.5);
+    std::vector<float> s = g.samples();
+
+    // the same transmissions heard by two blocks of the group: output once
+    d1.push(s.data(), s.size());
+    d1.flush();
+    d2.push(s.data(), s.size());
+    d2.flush();
+    demod_stats s1 = d1.stats(), s2 = d2.stats();
+    BOOST_CHECK_EQUAL(s1.bursts_decoded, 3u);
+    BOOST_CHECK_EQUAL(s1.duplicates, 0u);
+    BOOST_CHECK_EQUAL(s2.bursts_decoded, 3u);
+    BOOST_CHECK_EQUAL(s2.duplicates, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(in_order_with_workers)
+{
+    demod::config cfg;
+    cfg.decode_threads = 4;
+    cfg.decode_queue = 64;
+    demod d(cfg);
+    std::vector<float> s = frames(24, d.input_multiple());
+    d.push(s.data(), s.size());
+    d.flush();
+
+    // decoded concurrently, output in the order of the stream
+    BOOST_CHECK_EQUAL(d.dropped(), 0u);
+    demod_message m;
+    uint64_t last = 0;
+    int n = 0;
+    while (d.pull(m)) {
+        BOOST_CHECK(m.bcs_ok);
+        BOOST_CHECK(m.record.find("M" + std::to_string(100 + n)) != std::string::npos);
+        BOOST_CHECK((n == 0) || (m.offset > last));
+        last = m.offset;
+        n++;
+    }
+    BOOST_CHECK_EQUAL(n, 24);
+}
+
+BOOST_AUTO_TEST_CASE(full_queue_drops)
+{
+    // one slot, one worker, and the bursts of a whole stream detected at
+    // once: the detector does not wait for the decoder
+    demod::config cfg;
+    cfg.decode_threads = 1;
+    cfg.decode_queue = 1;
+    demod d(cfg);
+    std::vector<float> s = frames(24, d.input_multiple());
+    d.push(s.data(), s.size());
+    BOOST_CHECK_GT(d.dropped(), 0u);
+    BOOST_CHECK_LE(d.queue_depth(), 1);
+    BOOST_CHECK_EQUAL(d.max_queue_depth(), 1);
+    d.flush();
+
+    demod_stats st = d.stats();
+    BOOST_CHECK_EQUAL(st.bursts_detected, 24u);
+    BOOST_CHECK_EQUAL(st.dropped_bursts, d.dropped());
+    BOOST_CHECK_EQUAL(st.bursts_decoded + st.dropped_bursts, 24u);
+    BOOST_CHECK_EQUAL(st.queue_depth, 0);
+    BOOST_CHECK_EQUAL(d.queue_depth(), 0);
+
+    // the decoded ones are output, still in order
+    demod_message m;
+    uint64_t n = 0, last = 0;
+    while (d.pull(m)) {
+        BOOST_CHECK((n == 0) || (m.offset > last));
+        last = m.offset;
+        n++;
+    }
+    BOOST_CHECK_EQUAL(n, st.bursts_decoded);
+}
+
+BOOST_AUTO_TEST_CASE(configuration)
+{
+    demod::config cfg;
+    demod d(cfg);
+    int16_t x[16] = {};
+    BOOST_CHECK_THROW(d.push(x, 16), std::invalid_argument);
+    demod_message m;
+    BOOST_CHECK(!d.pull(m));
+
+    cfg.samp_rate = 9000;
+    BOOST_CHECK_THROW(demod{ cfg }, std::invalid_argument);
+    cfg.samp_rate = 44100;
+    BOOST_CHECK_EQUAL(demod(cfg).rate(), 44100);
+    cfg.samp_rate = 44100.5;
+    BOOST_CHECK_THROW(demod{ cfg }, std::invalid_argument);
+
+    // complex baseband is decimated to the nearest fast rate
+    cfg.input = demod::INPUT_COMPLEX;
+    cfg.samp_rate = 2.4e6;
+    demod c(cfg);
+    BOOST_CHECK_EQUAL(c.rate(), 48000);
+    BOOST_CHECK_EQUAL(c.input_multiple(), 50u);
+    std::vector<std::complex<float>> z(1234, std::complex<float>(0.1f, 0.0f));
+    c.push(z.data(), z.size());
+    c.flush();
+}
+
+BOOST_AUTO_TEST_CASE(stage_latencies)
+{
+    std::vector<float> s = keyed_signal(3);
+    demod::config cfg;
+    demod d(cfg);
+    const size_t chunk = d.input_multiple();
+    d.push(s.data(), 10 * chunk);
+    d.push(s.data() + 10 * chunk, s.size() - 10 * chunk);
+    d.flush();
+
+    std::vector<stage_latency> v = d.stage_latencies();
+#ifdef ACARS_STAGE_TIMING
+    BOOST_REQUIRE_EQUAL(v.size(), 8u);
+    BOOST_CHECK_EQUAL(v[0].name, std::string("push"));
+    BOOST_CHECK_EQUAL(v[0].count, 2u);
+    BOOST_CHECK(v[1].count >= s.size() / chunk); // and the quiet of flush()
+    for (size_t k = 2; k < v.size(); k++) {
+        BOOST_CHECK_EQUAL(v[k].count, d.decoded());
+    }
+    for (const stage_latency& l : v) {
+        BOOST_CHECK(l.p50_us <= l.p90_us);
+        BOOST_CHECK(l.p90_us <= l.p99_us);
+        BOOST_CHECK(l.p99_us <= l.max_us);
+        BOOST_CHECK(l.mean_us <= l.max_us);
+    }
+    d.reset_stage_latencies();
+    BOOST_CHECK_EQUAL(d.stage_latencies()[1].count, 0u);
+#else
+    BOOST_CHECK(v.empty());
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(counters)
+{
+    // keyed tones: bursts of 0.5 s, none of them a frame
+    std::vector<float> s = keyed_signal(4);
+    demod::config cfg;
+    demod d(cfg);
+    d.push(s.data(), s.size());
+    d.flush();
+
+    demod_stats st = d.stats();
+    BOOST_CHECK(st.samples >= s.size());
+    BOOST_CHECK_EQUAL(st.bursts_detected, 4u);
+    BOOST_CHECK_EQUAL(st.bursts_decoded, 4u);
+    BOOST_CHECK_EQUAL(st.sync_failures, 4u);
+    BOOST_CHECK_EQUAL(st.crc_failures, 0u);
+    BOOST_CHECK(std::fabs(st.mean_burst_ms - 500.0) < 50.0);
+    BOOST_CHECK(st.noise_floor > 0.0f && st.noise_floor < 0.05f);
+    BOOST_CHECK_EQUAL(st.queue_depth, 0);
+    BOOST_CHECK(st.cpu_per_burst_ms > 0.0);
+    BOOST_CHECK_EQUAL(st.dropped_bursts, 0u);
+    BOOST_CHECK_EQUAL(st.dropped_messages, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(metrics)
+{
+    const int port = 19464;
+    std::vector<float> s = keyed_signal(4);
+    demod::config cfg;
+    cfg.metrics_port = port;
+    cfg.metrics_name = "qa";
+    {
+        demod d(cfg);
+        d.push(s.data(), s.size());
+        d.flush();
+
+        std::string page = http_get(port, "/metrics");
+        BOOST_CHECK(page.find("HTTP/1.0 200") == 0);
+        BOOST_CHECK(page.find("\nacars_bursts_total{channel=\"qa\"} 4\n") !=
+                    std::string::npos);
+        BOOST_CHECK(page.find("\nacars_sync_failures_total{channel=\"qa\"} 4\n") !=
+                    std::string::npos);
+        BOOST_CHECK(page.find("\nacars_queue_depth{channel=\"qa\"} 0\n") !=
+                    std::string::npos);
+        BOOST_CHECK(page.find("\nacars_duplicates_total{channel=\"qa\"} 0\n") !=
+                    std::string::npos);
+#ifdef ACARS_STAGE_TIMING
+        BOOST_CHECK(page.find("acars_stage_seconds_count{channel=\"qa\",stage=\"latency\"} "
+                              "4\n") != std::string::npos);
+        BOOST_CHECK(page.find("acars_stage_seconds_bucket{channel=\"qa\",stage=\"latency\","
+                              "le=\"+Inf\"} 4\n") != std::string::npos);
+#endif
+        BOOST_CHECK(http_get(port, "/other").find("HTTP/1.0 404") == 0);
+    }
+    // the server goes with the last demod
+    BOOST_CHECK(http_get(port, "/metrics").empty());
+}
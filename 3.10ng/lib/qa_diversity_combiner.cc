@@ -0,0 +1,219 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The diversity combiner on soft bits of a known frame: one output per
+ * transmission, the valid copy picked when there is one, and a frame that
+ * no receiver decodes alone recovered by soft combining.
+ */
+
+#include "acars_bcs.h"
+#include "burst_decoder.h"
+#include "diversity_combiner.h"
+#include "message_output.h"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <random>
+#include <string>
+#include <time.h>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+unsigned char odd_parity(unsigned char c)
+{
+    int ones = 0;
+    for (int b = 0; b < 7; b++) {
+        ones += (c >> b) & 1;
+    }
+    return (ones & 1) ? c : (c | 0x80);
+}
+
+// "+*" SYN SYN SOH, a downlink with its BCS, then DEL and padding
+std::vector<unsigned char> make_frame()
+{
+    std::string text = "2.N12345\x15H11\x02M01AAB1234HELLO WORLD\x03";
+    std::vector<unsigned char> f;
+    for (unsigned char c : { 0x2b, 0x2a, 0x16, 0x16, 0x01 }) {
+        f.push_back(odd_parity(c));
+    }
+    for (char c : text) {
+        f.push_back(odd_parity((unsigned char)c));
+    }
+    uint16_t bcs = acars_bcs(&f[5], int(f.size()) - 5);
+    f.push_back(bcs & 0xff);
+    f.push_back(bcs >> 8);
+    f.push_back(odd_parity(0x7f));
+    f.push_back(0xff);
+    f.push_back(0xff);
+    return f;
+}
+
+// What the slicer outputs for this frame: +1/-1 per bit, with noise, the
+// frame starting \p shift bits late
+std::vector<float> soft_bits(const std::vector<unsigned char>& f,
+                             float sigma,
+                             int shift,
+                             std::mt19937& rng)
+{
+    std::vector<int> t;
+    for (unsigned char c : f) {
+        for (int b = 0; b < 8; b++) {
+            t.push_back((c >> b) & 1);
+        }
+    }
+    std::normal_distribution<float> noise(0.0f, sigma);
+    std::vector<float> s(shift, 1.0f); // pre-key
+    for (size_t idx = 0; idx + 2 < t.size(); idx++) {
+        float v = (t[idx + 2] == t[idx + 1]) ? 1.0f : -1.0f;
+        s.push_back(v + ((sigma > 0.0f) ? noise(rng) : 0.0f));
+    }
+    s[0] = -1.0f;
+    return s;
+}
+
+void fill(burst& b, const std::vector<float>& soft, uint64_t offset)
+{
+    static burst_decoder dec;
+    std::copy(soft.begin(), soft.end(), b.soft.begin());
+    b.nbits = int(soft.size());
+    b.offset = offset;
+    dec.frame(b);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(picks_the_valid_copy)
+{
+    message_output out("/dev/null", 0, 0, 0.0f, "", 0.0f, 0.0f, "qa");
+    diversity_combiner comb(3, 4800, &out);
+    std::mt19937 rng(1);
+    std::vector<unsigned char> f = make_frame();
+
+    burst b;
+    fill(b, soft_bits(f, 0.0f, 0, rng), 1000);
+    BOOST_REQUIRE(b.bcs_ok);
+    comb.add(0, b);
+    fill(b, soft_bits(f, 0.8f, 0, rng), 1100);
+    comb.add(1, b);
+    BOOST_CHECK_EQUAL(comb.transmissions(), 0u); // receiver 2 may still report
+    fill(b, soft_bits(f, 0.8f, 0, rng), 1050);
+    comb.add(2, b);
+
+    BOOST_CHECK_EQUAL(comb.transmissions(), 1u);
+    BOOST_CHECK_EQUAL(comb.picked(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(keeps_the_label_and_time)
+{
+    message_output out("", 0, 0, 0.0f, "", 0.0f, 0.0f, "qa", false);
+    diversity_combiner comb(2, 4800, &out, "131.725");
+    std::mt19937 rng(5);
+    std::vector<unsigned char> f = make_frame();
+    burst b;
+
+    // the valid copy comes from the receiver that heard the burst last
+    struct timespec early = { 86400 * 365, 0 };
+    struct timespec late = { early.tv_sec + 3600, 0 };
+    fill(b, soft_bits(f, 0.0f, 0, rng), 1100);
+    comb.add(0, b, &late);
+    fill(b, soft_bits(f, 0.8f, 0, rng), 1000);
+    comb.add(1, b, &early);
+    BOOST_REQUIRE_EQUAL(comb.picked(), 1u);
+
+    char date[32];
+    ctime_r(&early.tv_sec, date);
+    BOOST_CHECK(out.record().find(date) != std::string::npos);
+    BOOST_CHECK(out.record().find("\nChannel=131.725\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(soft_combining_beats_each_receiver)
+{
+    std::vector<unsigned char> f = make_frame();
+    const int trials = 50;
+    const int receivers = 3;
+    int single_ok = 0;
+    int combined_ok = 0;
+    std::mt19937 rng(2);
+    message_output out("/dev/null", 0, 0, 0.0f, "", 0.0f, 0.0f, "qa");
+    diversity_combiner comb(receivers, 4800, &out);
+    burst b;
+
+    for (int t = 0; t < trials; t++) {
+        uint64_t offset = uint64_t(t) * 48000;
+        for (int r = 0; r < receivers; r++) {
+            // one bit error anywhere loses the frame
+            fill(b, soft_bits(f, 0.45f, 0, rng), offset + 100 * r);
+            single_ok += b.bcs_ok ? 1 : 0;
+            comb.add(r, b);
+        }
+    }
+    comb.flush();
+    combined_ok = int(comb.picked() + comb.combined());
+
+    BOOST_CHECK_EQUAL(comb.transmissions(), uint64_t(trials));
+    BOOST_TEST_MESSAGE("single receiver: " << single_ok << "/" << receivers * trials
+                                           << ", combined: " << combined_ok << "/"
+                                           << trials);
+    // a lone receiver decodes a minority of the frames, the combination most
+    BOOST_CHECK_LT(double(single_ok) / (receivers * trials), 0.5);
+    BOOST_CHECK_GT(double(combined_ok) / trials, 0.9);
+    BOOST_CHECK_GT(comb.combined(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(aligns_the_bit_timing)
+{
+    message_output out("/dev/null", 0, 0, 0.0f, "", 0.0f, 0.0f, "qa");
+    diversity_combiner comb(3, 4800, &out);
+    std::mt19937 rng(4);
+    std::vector<unsigned char> f = make_frame();
+    burst b;
+
+    // the slicers of receivers 1 and 2 started 3 and 7 bits early, so that
+    // none of them frames the message alone
+    const int shift[] = { 0, 3, 7 };
+    for (int r = 0; r < 3; r++) {
+        fill(b, soft_bits(f, (r == 0) ? 0.8f : 0.3f, shift[r], rng), 1000 + r);
+        if (r > 0) {
+            BOOST_CHECK(!b.bcs_ok);
+        }
+        comb.add(r, b);
+    }
+    BOOST_CHECK_EQUAL(comb.transmissions(), 1u);
+    BOOST_CHECK_EQUAL(comb.combined(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(one_output_per_transmission)
+{
+    message_output out("/dev/null", 0, 0, 0.0f, "", 0.0f, 0.0f, "qa");
+    diversity_combiner comb(2, 4800, &out);
+    std::mt19937 rng(3);
+    std::vector<unsigned char> f = make_frame();
+    burst b;
+
+    // heard by receiver 0 only: resolved once receiver 1 has moved past it
+    fill(b, soft_bits(f, 0.0f, 0, rng), 10000);
+    comb.add(0, b);
+    comb.settle(1, 12000);
+    BOOST_CHECK_EQUAL(comb.transmissions(), 0u);
+    comb.settle(1, 20000);
+    BOOST_CHECK_EQUAL(comb.transmissions(), 1u);
+
+    // two transmissions on both receivers, reported out of step
+    fill(b, soft_bits(f, 0.0f, 0, rng), 50000);
+    comb.add(0, b);
+    fill(b, soft_bits(f, 0.0f, 0, rng), 100000);
+    comb.add(0, b);
+    fill(b, soft_bits(f, 0.0f, 0, rng), 50200);
+    comb.add(1, b);
+    fill(b, soft_bits(f, 0.0f, 0, rng), 100300);
+    comb.add(1, b);
+    BOOST_CHECK_EQUAL(comb.transmissions(), 3u);
+    BOOST_CHECK_EQUAL(comb.picked(), 3u);
+    comb.flush();
+    BOOST_CHECK_EQUAL(comb.transmissions(), 3u);
+}
@@ -0,0 +1,125 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The integer input path against the float one: exact sums from the NEON /
+ * SSE2 kernels, and the same bursts detected on the same signal given as
+ * int16, int8 or float samples.
+ */
+
+#include "fixed_point.h"
+#include "qa_signals.h"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace gr::acars;
+using namespace gr::acars::qa;
+
+namespace {
+
+template <typename T>
+sample_stats reference(const std::vector<T>& x, int n)
+{
+    sample_stats s = { 0, 0 };
+    for (int k = 0; k < n; k++) {
+        s.sum += x[k];
+        s.sumsq += int64_t(x[k]) * x[k];
+    }
+    return s;
+}
+
+template <typename T>
+std::vector<T> random_samples(size_t n, unsigned seed)
+{
+    std::vector<T> x(n);
+    for (auto& v : x) {
+        seed = seed * 1103515245u + 12345u;
+        v = T(seed >> 16);
+    }
+    return x;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(stats_s16_exact)
+{
+    std::vector<int16_t> x = random_samples<int16_t>(4096, 7);
+    // every length, to cover the vector loop and the scalar tail
+    for (int n = 0; n <= 100; n++) {
+        sample_stats s = stats_s16(x.data(), n);
+        sample_stats r = reference(x, n);
+        BOOST_CHECK_EQUAL(s.sum, r.sum);
+        BOOST_CHECK_EQUAL(s.sumsq, r.sumsq);
+    }
+    sample_stats s = stats_s16(x.data() + 3, 4093); // unaligned
+    BOOST_CHECK_EQUAL(s.sumsq, reference(std::vector<int16_t>(x.begin() + 3, x.end()),
+                                         4093).sumsq);
+}
+
+BOOST_AUTO_TEST_CASE(stats_s16_full_scale)
+{
+    // pairs of -32768 squared overflow a signed 32-bit lane
+    std::vector<int16_t> x(2048, std::numeric_limits<int16_t>::min());
+    sample_stats s = stats_s16(x.data(), int(x.size()));
+    BOOST_CHECK_EQUAL(s.sum, -32768LL * 2048);
+    BOOST_CHECK_EQUAL(s.sumsq, 32768LL * 32768 * 2048);
+    BOOST_CHECK_EQUAL(stats_stddev(s, int(x.size()), 1.0f), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(stats_s8_exact)
+{
+    std::vector<int8_t> x = random_samples<int8_t>(4096, 11);
+    for (int n = 0; n <= 100; n++) {
+        sample_stats s = stats_s8(x.data(), n);
+        sample_stats r = reference(x, n);
+        BOOST_CHECK_EQUAL(s.sum, r.sum);
+        BOOST_CHECK_EQUAL(s.sumsq, r.sumsq);
+    }
+    std::vector<int8_t> m(1000, std::numeric_limits<int8_t>::min());
+    BOOST_CHECK_EQUAL(stats_s8(m.data(), 1000).sumsq, 128LL * 128 * 1000);
+}
+
+BOOST_AUTO_TEST_CASE(stddev_matches_float)
+{
+    std::vector<int16_t> x = random_samples<int16_t>(1024, 3);
+    double avg = 0.0;
+    for (int16_t v : x) {
+        avg += v / 32768.0;
+    }
+    avg /= x.size();
+    double var = 0.0;
+    for (int16_t v : x) {
+        var += (v / 32768.0 - avg) * (v / 32768.0 - avg);
+    }
+    float expected = float(std::sqrt(var / x.size()));
+    float got = stats_stddev(stats_s16(x.data(), int(x.size())), int(x.size()),
+                             1.0f / 32768);
+    BOOST_CHECK_CLOSE(got, expected, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(same_bursts_as_float)
+{
+    std::vector<float> f = keyed_signal(6);
+    std::vector<int16_t> s(f.size());
+    std::vector<int8_t> c(f.size());
+    std::vector<float> fs(f.size()), fc(f.size());
+    for (size_t k = 0; k < f.size(); k++) {
+        s[k] = int16_t(std::lround(f[k] * 32767));
+        c[k] = int8_t(std::lround(f[k] * 127));
+        // the float path on exactly the same quantized samples
+        fs[k] = s[k] / 32768.0f;
+        fc[k] = c[k] / 128.0f;
+    }
+    const size_t step = 4096;
+    uint64_t n = bursts(f, step, false);
+    BOOST_CHECK_EQUAL(n, 6u);
+    BOOST_CHECK_EQUAL(bursts(s, step, false), bursts(fs, step, false));
+    BOOST_CHECK_EQUAL(bursts(c, step, false), bursts(fc, step, false));
+    BOOST_CHECK_EQUAL(bursts(s, step, false), n);
+    BOOST_CHECK_EQUAL(bursts(c, step, false), n);
+}
@@ -0,0 +1,130 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The synthetic signal generator, through the decoder: its frames have a
+ * valid BCS, and they decode under the channel impairments it applies.
+ */
+
+#include "acars_bcs.h"
+#include <acars/demod.h>
+#include <acars/generator.h>
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+// The detector starts a burst at the first sample over its threshold in the
+// first chunk, which may be a noise peak well ahead of the burst: the bursts
+// start on a chunk for the tests to see the demodulator only.
+int chunk(double rate)
+{
+    demod::config cfg;
+    cfg.samp_rate = rate;
+    return int(demod(cfg).input_multiple());
+}
+
+// the frames decoded from the samples, with a valid BCS
+std::vector<std::string> decode(const generator& g, double rate)
+{
+    demod::config cfg;
+    cfg.samp_rate = rate;
+    demod d(cfg);
+    const std::vector<float>& s = g.samples();
+    d.push(s.data(), s.size());
+    d.flush();
+    std::vector<std::string> frames;
+    demod_message m;
+    while (d.pull(m)) {
+        if (m.bcs_ok) {
+            frames.push_back(m.frame);
+        }
+    }
+    return frames;
+}
+
+acars_message numbered(int k)
+{
+    acars_message m;
+    m.msn[3] = char('A' + k % 26);
+    m.text = "MESSAGE " + std::to_string(k);
+    return m;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(frames_have_a_valid_bcs)
+{
+    acars_message m;
+    std::vector<unsigned char> f = generator::frame(m);
+    BOOST_CHECK(acars_bcs_ok(f.data(), int(f.size())));
+    BOOST_CHECK_EQUAL(f.size(), 5u + 12 + 11 + m.text.size() + 4);
+    f[20] ^= 0x01;
+    BOOST_CHECK(!acars_bcs_ok(f.data(), int(f.size())));
+
+    m.label = "H";
+    BOOST_CHECK_THROW(generator::frame(m), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(clean_bursts_decode)
+{
+    for (double rate : { 48000.0, 12000.0, 44100.0 }) {
+        generator::config cfg;
+        cfg.samp_rate = rate;
+        cfg.snr_db = 40.0f; // the detector needs some noise between bursts
+        cfg.align = chunk(rate);
+        generator g(cfg);
+        for (int k = 0; k < 4; k++) {
+            g.add(numbered(k));
+        }
+        g.add_noise(0.5);
+        std::vector<std::string> frames = decode(g, rate);
+        BOOST_REQUIRE_EQUAL(frames.size(), 4u);
+        BOOST_CHECK(frames[3].find("MESSAGE 3") != std::string::npos);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(impaired_bursts_decode)
+{
+    generator::config cfg;
+    cfg.snr_db = 30.0f;
+    cfg.align = chunk(cfg.samp_rate);
+    cfg.imbalance_db = -6.0f;
+    cfg.clock_ppm = 100.0;
+    cfg.drift_ppm_s = 5.0;
+    cfg.dc = 0.1f;
+    generator g(cfg);
+    for (int k = 0; k < 5; k++) {
+        g.add(numbered(k));
+    }
+    g.add_noise(0.5);
+    BOOST_CHECK_EQUAL(decode(g, cfg.samp_rate).size(), 5u);
+
+    // the same configuration gives the same samples
+    generator h(cfg);
+    for (int k = 0; k < 5; k++) {
+        h.add(numbered(k));
+    }
+    h.add_noise(0.5);
+    BOOST_CHECK(g.samples() == h.samples());
+}
+
+BOOST_AUTO_TEST_CASE(noise_loses_frames)
+{
+    generator::config cfg;
+    cfg.snr_db = 15.0f;
+    cfg.align = chunk(cfg.samp_rate);
+    cfg.seed = 7;
+    generator g(cfg);
+    for (int k = 0; k < 10; k++) {
+        g.add(numbered(k));
+    }
+    g.add_noise(0.5);
+    BOOST_CHECK_LT(decode(g, cfg.samp_rate).size(), 10u);
+}
@@ -0,0 +1,226 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The segment log in a temporary directory: rotation on size and on age,
+ * the spare segment preallocated ahead of the writer, the fdatasync()
+ * cadence, and the writes that keep trying after a rotation has failed.
+ */
+
+#include "segment_log.h"
+#include <boost/test/unit_test.hpp>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gr::acars;
+
+// The test binary stands in for these two calls of the C library, to count
+// the syncs and to fail the preallocation of a segment as a full disk would
+namespace {
+std::atomic<int> syncs(0);
+std::atomic<bool> disk_full(false);
+} // namespace
+
+extern "C" int fdatasync(int fd)
+{
+    syncs.fetch_add(1);
+    return int(syscall(SYS_fdatasync, fd));
+}
+
+extern "C" int posix_fallocate(int fd, off_t offset, off_t len)
+{
+    if (disk_full.load()) {
+        return ENOSPC;
+    }
+    return (syscall(SYS_fallocate, fd, 0, offset, len) == 0) ? 0 : errno;
+}
+
+namespace {
+
+// A fresh directory, removed with its files
+struct temp_dir {
+    std::string path;
+
+    temp_dir()
+    {
+        char p[] = "/tmp/acars_qa_log_XXXXXX";
+        BOOST_REQUIRE(mkdtemp(p) != nullptr);
+        path = p;
+    }
+    ~temp_dir()
+    {
+        for (const auto& f : files()) {
+            unlink(f.c_str());
+        }
+        rmdir(path.c_str());
+    }
+
+    std::string prefix() const { return path + "/acars"; }
+
+    //! The segments, oldest first
+    std::vector<std::string> files() const
+    {
+        std::vector<std::string> v;
+        DIR* d = opendir(path.c_str());
+        if (d == nullptr) {
+            return v;
+        }
+        while (struct dirent* e = readdir(d)) {
+            if (e->d_name[0] != '.') {
+                v.push_back(path + "/" + e->d_name);
+            }
+        }
+        closedir(d);
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+};
+
+std::string contents(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream s;
+    s << in.rdbuf();
+    return s.str();
+}
+
+off_t size_of(const std::string& path)
+{
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? st.st_size : -1;
+}
+
+std::string record(int k)
+{
+    std::string r = "\nrecord " + std::to_string(k);
+    r.resize(30, '.');
+    return r;
+}
+
+void pause_ms(int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(size_rotation)
+{
+    temp_dir dir;
+    std::string all;
+    {
+        segment_log log(dir.prefix(), 100, 0, 0.0f);
+        for (int k = 0; k < 7; k++) {
+            log.write(record(k).data(), 30);
+            all += record(k);
+        }
+        BOOST_CHECK_EQUAL(log.dropped(), 0u);
+    }
+
+    // three records in a segment, trimmed to the used length, and no empty
+    // spare segment left behind
+    std::vector<std::string> f = dir.files();
+    BOOST_REQUIRE_EQUAL(f.size(), 3u);
+    BOOST_CHECK_EQUAL(size_of(f[0]), 90);
+    BOOST_CHECK_EQUAL(size_of(f[1]), 90);
+    BOOST_CHECK_EQUAL(size_of(f[2]), 30);
+    BOOST_CHECK_EQUAL(contents(f[0]) + contents(f[1]) + contents(f[2]), all);
+    BOOST_CHECK_EQUAL(f[0].compare(0, dir.prefix().size() + 1, dir.prefix() + "."), 0);
+}
+
+BOOST_AUTO_TEST_CASE(time_rotation)
+{
+    temp_dir dir;
+    {
+        segment_log log(dir.prefix(), 4096, 1, 0.0f);
+        log.write(record(0).data(), 30);
+        log.write(record(1).data(), 30);
+        pause_ms(1100);
+        log.write(record(2).data(), 30);
+    }
+    std::vector<std::string> f = dir.files();
+    BOOST_REQUIRE_EQUAL(f.size(), 2u);
+    BOOST_CHECK_EQUAL(contents(f[0]), record(0) + record(1));
+    BOOST_CHECK_EQUAL(contents(f[1]), record(2));
+}
+
+BOOST_AUTO_TEST_CASE(spare_segment)
+{
+    temp_dir dir;
+    segment_log log(dir.prefix(), 8192, 0, 0.0f);
+    log.write(record(0).data(), 30);
+    pause_ms(200);
+
+    // the current segment and the spare one, both at their full size already
+    std::vector<std::string> f = dir.files();
+    BOOST_REQUIRE_EQUAL(f.size(), 2u);
+    for (const auto& s : f) {
+        struct stat st;
+        BOOST_REQUIRE(stat(s.c_str(), &st) == 0);
+        BOOST_CHECK_EQUAL(st.st_size, 8192);
+        BOOST_CHECK_GE(st.st_blocks * 512, 8192);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fsync_cadence)
+{
+    temp_dir dir;
+    {
+        segment_log log(dir.prefix(), 4096, 0, 0.1f);
+        log.write(record(0).data(), 30);
+        pause_ms(50);
+        int before = syncs.load();
+        pause_ms(550);
+        int n = syncs.load() - before;
+        BOOST_CHECK_GE(n, 3);
+        BOOST_CHECK_LE(n, 7);
+    }
+    {
+        segment_log log(dir.prefix(), 4096, 0, 0.0f);
+        log.write(record(1).data(), 30);
+        int before = syncs.load();
+        pause_ms(300);
+        BOOST_CHECK_EQUAL(syncs.load() - before, 0); // only when the segment closes
+    }
+}
+
+BOOST_AUTO_TEST_CASE(retry_after_failed_rotation)
+{
+    temp_dir dir;
+    {
+        segment_log log(dir.prefix(), 100, 0, 0.0f);
+        pause_ms(100); // the spare segment is ready
+        disk_full = true;
+
+        // the spare takes over, then no segment can be opened any more
+        for (int k = 0; k < 6; k++) {
+            log.write(record(k).data(), 30);
+        }
+        BOOST_CHECK_EQUAL(log.dropped(), 0u);
+        log.write(record(6).data(), 30);
+        log.write(record(7).data(), 30);
+        BOOST_CHECK_EQUAL(log.dropped(), 2u);
+
+        // space again: the next write opens a segment
+        disk_full = false;
+        log.write(record(8).data(), 30);
+        BOOST_CHECK_EQUAL(log.dropped(), 2u);
+    }
+    std::vector<std::string> f = dir.files();
+    BOOST_REQUIRE_EQUAL(f.size(), 3u);
+    BOOST_CHECK_EQUAL(contents(f[0]), record(0) + record(1) + record(2));
+    BOOST_CHECK_EQUAL(contents(f[1]), record(3) + record(4) + record(5));
+    BOOST_CHECK_EQUAL(contents(f[2]), record(8));
+}
@@ -0,0 +1,152 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * The shared-memory ring within one process: items of any size keep their
+ * place across the end of the ring, a lapped reader counts its losses and
+ * resumes behind the writer, done() notices the items overwritten while
+ * they were read, and readers see the writer go.
+ */
+
+#include "shm_ring.h"
+#include <boost/test/unit_test.hpp>
+#include <unistd.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+// 12 bytes: does not divide a page
+struct item {
+    uint32_t seq;
+    uint32_t check;
+    uint32_t pad;
+};
+
+std::string ring_name(const char* test)
+{
+    return "acars_qa_" + std::string(test) + "_" + std::to_string(getpid());
+}
+
+std::vector<item> items(uint32_t first, size_t n)
+{
+    std::vector<item> v(n);
+    for (size_t k = 0; k < n; k++) {
+        v[k].seq = first + uint32_t(k);
+        v[k].check = ~v[k].seq;
+        v[k].pad = 0;
+    }
+    return v;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(items_keep_their_place)
+{
+    const std::string name = ring_name("place");
+    std::unique_ptr<shm_ring> w = shm_ring::create(name, sizeof(item), 300);
+    BOOST_REQUIRE(w);
+    BOOST_CHECK(w->capacity() >= 300);
+    BOOST_CHECK_EQUAL(w->capacity() * sizeof(item) % size_t(sysconf(_SC_PAGESIZE)), 0u);
+
+    std::unique_ptr<shm_ring> r = shm_ring::attach(name, sizeof(item));
+    BOOST_REQUIRE(r);
+    BOOST_CHECK_EQUAL(r->capacity(), w->capacity());
+    BOOST_CHECK_THROW(shm_ring::attach(name, 8), std::invalid_argument);
+
+    // batches of a size prime to the capacity, over several laps, so that
+    // reads straddle the end of the ring
+    const size_t batch = 77;
+    uint32_t next = 0;
+    uint32_t expected = 0;
+    for (int k = 0; k < 10 * int(w->capacity() / batch); k++) {
+        std::vector<item> v = items(next, batch);
+        w->write(v.data(), v.size());
+        next += batch;
+
+        const void* p;
+        size_t n = r->read(&p, batch, 0);
+        BOOST_REQUIRE_EQUAL(n, batch);
+        const item* it = static_cast<const item*>(p);
+        for (size_t j = 0; j < n; j++) {
+            if ((it[j].seq != expected) || (it[j].check != ~expected)) {
+                BOOST_FAIL("item " << expected << " read as " << it[j].seq);
+            }
+            expected++;
+        }
+        BOOST_CHECK(r->done());
+    }
+    BOOST_CHECK_EQUAL(r->overruns(), 0u);
+    const void* p;
+    BOOST_CHECK_EQUAL(r->read(&p, batch, 0), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(lapped_reader)
+{
+    const std::string name = ring_name("lapped");
+    std::unique_ptr<shm_ring> w = shm_ring::create(name, sizeof(item), 512);
+    std::unique_ptr<shm_ring> r = shm_ring::attach(name, sizeof(item));
+    BOOST_REQUIRE(r);
+    const uint64_t cap = w->capacity();
+
+    // the writer runs a ring and a half ahead: the reader loses the oldest
+    // items and resumes half a ring behind
+    uint32_t next = 0;
+    for (int k = 0; k < 3; k++) {
+        std::vector<item> v = items(next, size_t(cap / 2));
+        w->write(v.data(), v.size());
+        next += uint32_t(cap / 2);
+    }
+    const void* p;
+    size_t n = r->read(&p, cap, 0);
+    BOOST_CHECK_EQUAL(n, cap / 2);
+    BOOST_CHECK_EQUAL(r->overruns(), next - cap / 2);
+    BOOST_CHECK_EQUAL(static_cast<const item*>(p)[0].seq, next - cap / 2);
+    BOOST_CHECK(r->done());
+    BOOST_CHECK_EQUAL(r->position(), next);
+
+    // items overwritten while they were being read are given back as lost
+    std::vector<item> v = items(next, 8);
+    w->write(v.data(), v.size());
+    next += 8;
+    BOOST_CHECK_EQUAL(r->read(&p, 8, 0), 8u);
+    const uint64_t before = r->overruns();
+    v = items(next, size_t(cap));
+    w->write(v.data(), v.size());
+    BOOST_CHECK(!r->done());
+    BOOST_CHECK_EQUAL(r->overruns(), before + 8);
+}
+
+BOOST_AUTO_TEST_CASE(writer_gone)
+{
+    const std::string name = ring_name("gone");
+    BOOST_CHECK(!shm_ring::attach(name, sizeof(item)));
+    std::unique_ptr<shm_ring> w = shm_ring::create(name, sizeof(item), 64);
+    std::unique_ptr<shm_ring> r = shm_ring::attach(name, sizeof(item));
+    BOOST_REQUIRE(r);
+    BOOST_CHECK(!r->closed());
+
+    // a new writer of the same name closes the ring of the old one
+    std::unique_ptr<shm_ring> w2 = shm_ring::create(name, sizeof(item), 64);
+    BOOST_CHECK(r->closed());
+    std::unique_ptr<shm_ring> r2 = shm_ring::attach(name, sizeof(item));
+    BOOST_REQUIRE(r2);
+    BOOST_CHECK(!r2->closed());
+
+    // the old writer leaves the new ring alone
+    w.reset();
+    BOOST_CHECK(!r2->closed());
+    const void* p;
+    BOOST_CHECK_EQUAL(r2->read(&p, 1, 10), 0u);
+
+    w2.reset();
+    BOOST_CHECK(r2->closed());
+    BOOST_CHECK_EQUAL(r2->read(&p, 1, 1000), 0u);
+    BOOST_CHECK(!shm_ring::attach(name, sizeof(item)));
+}
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Test signals and their decoding, shared by the unit tests of the core.
+ */
+
+#ifndef INCLUDED_ACARS_QA_SIGNALS_H
+#define INCLUDED_ACARS_QA_SIGNALS_H
+
+#include <acars/demod.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace gr {
+namespace acars {
+namespace qa {
+
+/*!
+ * \brief Keyed tones at 48 kHz, not frames: 0.5 s bursts every second over
+ * noise, starting with 0.25 s of noise, in units of full scale.
+ */
+inline std::vector<float> keyed_signal(double seconds, float amplitude = 0.25f)
+{
+    const int rate = 48000;
+    std::vector<float> s(size_t(seconds * rate));
+    unsigned seed = 1;
+    for (size_t t = 0; t < s.size(); t++) {
+        seed = seed * 1103515245u + 12345u;
+        float noise = 0.05f * (float((seed >> 16) & 0x7fff) / 16384.0f - 1.0f);
+        bool on = (t % rate) >= size_t(rate / 4) && (t % rate) < size_t(3 * rate / 4);
+        float f = ((t / 20) & 1) ? 2400.0f : 1200.0f;
+        s[t] = amplitude *
+               (noise + (on ? std::sin(2.0f * float(M_PI) * f * t / rate) : 0.0f));
+    }
+    return s;
+}
+
+inline demod::input_type input_of(const float*) { return demod::INPUT_FLOAT; }
+inline demod::input_type input_of(const int16_t*) { return demod::INPUT_SHORT; }
+inline demod::input_type input_of(const int8_t*) { return demod::INPUT_CHAR; }
+
+//! Bursts decoded from \p s at 48 kHz, pushed \p step samples at a time,
+//! then the stream ended if \p flush
+template <typename T>
+uint64_t bursts(const std::vector<T>& s, size_t step, bool flush)
+{
+    demod::config cfg;
+    cfg.input = input_of(s.data());
+    demod d(cfg);
+    for (size_t k = 0; k < s.size(); k += step) {
+        d.push(&s[k], std::min(step, s.size() - k));
+    }
+    if (flush) {
+        d.flush();
+    }
+    return d.decoded();
+}
+
+} // namespace qa
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_QA_SIGNALS_H */
@@ -0,0 +1,224 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "segment_log.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace gr {
+namespace acars {
+
+segment_log::segment_log(const std::string& prefix,
+                         size_t segment_size,
+                         int rotate_seconds,
+                         float fsync_interval)
+    : _prefix(prefix),
+      _size(segment_size),
+      _rotate(rotate_seconds > 0 ? rotate_seconds : 0),
+      _fsync(fsync_interval > 0.0f ? int(fsync_interval * 1000.0f) : 0),
+      _seq(0),
+      _dropped(0),
+      _running(true)
+{
+    time_t tm;
+    time(&tm);
+    char s[32];
+    std::strftime(s, sizeof(s), "%Y%m%d_%H%M%S", std::localtime(&tm));
+    _stamp = s;
+
+    _retired.reserve(4);
+    if (open_segment(_current, _seq++)) {
+        _current.opened = std::chrono::steady_clock::now();
+    }
+    _thread = std::thread(&segment_log::helper, this);
+}
+
+segment_log::~segment_log()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _cond.notify_one();
+    _thread.join();
+
+    for (auto& s : _retired) {
+        close_segment(s);
+    }
+    close_segment(_current);
+    close_segment(_spare);
+}
+
+// ----------------------------------------------------------------------------
+// open_segment(): create, preallocate and map segment number n
+// ----------------------------------------------------------------------------
+bool segment_log::open_segment(segment& s, unsigned n)
+{
+    char suffix[16];
+    int fd = -1;
+    // O_EXCL: never reuse a segment left by a previous run in the same second
+    for (int attempt = 0; (fd < 0) && (attempt < 100); attempt++) {
+        std::snprintf(suffix, sizeof(suffix), ".%04u", n + 100 * attempt);
+        s.path = _prefix + "." + _stamp + suffix;
+        fd = ::open(s.path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if ((fd < 0) && (errno != EEXIST)) {
+            break;
+        }
+    }
+    if (fd < 0) {
+        std::perror("Failed to create log segment");
+        return false;
+    }
+
+    int err = posix_fallocate(fd, 0, _size);
+    if (err != 0) {
+        std::fprintf(stderr, "Failed to preallocate %s: %s\n", s.path.c_str(),
+                     std::strerror(err));
+        ::close(fd);
+        ::unlink(s.path.c_str());
+        return false;
+    }
+
+    void* base = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        std::perror("Failed to map log segment");
+        ::close(fd);
+        ::unlink(s.path.c_str());
+        return false;
+    }
+
+    s.fd = fd;
+    s.base = static_cast<char*>(base);
+    s.used = 0;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// close_segment(): unmap, trim the preallocated tail and close
+// ----------------------------------------------------------------------------
+void segment_log::close_segment(segment& s)
+{
+    if (s.fd < 0) {
+        return;
+    }
+    ::munmap(s.base, _size);
+    if (s.used == 0) {
+        // never written (spare or idle segment): do not leave empty files
+        ::unlink(s.path.c_str());
+    } else if (::ftruncate(s.fd, s.used) == 0) {
+        ::fdatasync(s.fd);
+    }
+    ::close(s.fd);
+    s = segment();
+}
+
+// ----------------------------------------------------------------------------
+// rotate(): retire the current segment and switch to the spare one
+// ----------------------------------------------------------------------------
+void segment_log::rotate()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_current.fd >= 0) {
+            _retired.push_back(std::move(_current));
+        }
+        _current = segment();
+        if (_spare.fd >= 0) {
+            _current = std::move(_spare);
+        } else {
+            // the helper could not keep up: open the segment ourselves
+            open_segment(_current, _seq++);
+        }
+        _spare = segment();
+        _current.opened = std::chrono::steady_clock::now();
+    }
+    _cond.notify_one();
+}
+
+void segment_log::write(const char* buf, size_t len)
+{
+    if (len > _size) {
+        len = _size; // a record never spans two segments
+    }
+    // without a segment, after a failed rotation, take the spare one if the
+    // helper has managed to open it, else try again
+    if ((_current.fd < 0) || (_current.used + len > _size) ||
+        ((_rotate.count() > 0) &&
+         (std::chrono::steady_clock::now() - _current.opened >= _rotate))) {
+        rotate();
+    }
+    if (_current.fd < 0) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::memcpy(_current.base + _current.used, buf, len);
+    _current.used += len;
+}
+
+// ----------------------------------------------------------------------------
+// helper(): prepare the spare segment, finalize retired ones, fsync cadence
+// ----------------------------------------------------------------------------
+void segment_log::helper()
+{
+    std::vector<segment> retired;
+    retired.reserve(4);
+    auto next_sync = std::chrono::steady_clock::now() + _fsync;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_running) {
+        bool failed = false;
+        if (_spare.fd < 0) {
+            segment s;
+            unsigned n = _seq++;
+            lock.unlock();
+            failed = !open_segment(s, n);
+            lock.lock();
+            if (!failed) {
+                _spare = std::move(s);
+            }
+        }
+
+        retired.swap(_retired);
+        auto now = std::chrono::steady_clock::now();
+        // the current fd stays open until this thread itself closes it
+        int fd = -1;
+        if ((_fsync.count() > 0) && (now >= next_sync)) {
+            fd = _current.fd;
+            next_sync = now + _fsync;
+        }
+        lock.unlock();
+
+        for (auto& s : retired) {
+            close_segment(s);
+        }
+        retired.clear();
+        if (fd >= 0) {
+            ::fdatasync(fd);
+        }
+
+        lock.lock();
+        if (!_running) {
+            break;
+        }
+        if (_retired.empty()) {
+            // on failure (disk full?) retry the spare segment a second later
+            auto deadline = ((_fsync.count() > 0) && !failed)
+                                ? next_sync
+                                : std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            _cond.wait_until(lock, deadline);
+        }
+    }
+}
+
+} // namespace acars
+} // namespace gr
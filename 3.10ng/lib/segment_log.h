@@ -0,0 +1,100 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_SEGMENT_LOG_H
+#define INCLUDED_ACARS_SEGMENT_LOG_H
+
+#include "log_sink.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Log backend writing into preallocated, memory-mapped segments.
+ *
+ * Each segment is a file of fixed size, reserved with posix_fallocate() and
+ * mapped MAP_SHARED, so appending a record is a memcpy() into the page cache:
+ * no stdio buffering, no per-message write(2) and no file size update.
+ * Segments are named <prefix>.<YYYYmmdd_HHMMSS>.<nnnn> and are rotated when
+ * full or when older than \p rotate_seconds.
+ *
+ * A helper thread keeps the next segment ready, fdatasync()s the current one
+ * every \p fsync_interval seconds and finalizes retired segments (unmap,
+ * truncate to the used length, close), so none of these system calls run
+ * on the caller's thread in steady state. A segment left by a crash keeps
+ * its preallocated size: the unused tail is filled with NUL bytes. While no
+ * segment can be opened (disk full?), every write() tries again and the
+ * records are counted as dropped.
+ */
+class segment_log : public log_sink
+{
+private:
+    struct segment {
+        std::string path;
+        int fd;
+        char* base;
+        size_t used;
+        std::chrono::steady_clock::time_point opened;
+        segment() : fd(-1), base(nullptr), used(0) {}
+    };
+
+    std::string _prefix;
+    size_t _size;
+    std::chrono::seconds _rotate;
+    std::chrono::milliseconds _fsync;
+    std::string _stamp; ///< constructor time, shared by all segment names
+    unsigned _seq;      ///< next segment number
+
+    segment _current;
+    segment _spare;                ///< next segment, prepared by the helper
+    std::vector<segment> _retired;  ///< full segments waiting to be finalized
+    std::atomic<uint64_t> _dropped; ///< records written to no segment
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _running;
+    std::thread _thread;
+
+    bool open_segment(segment& s, unsigned n);
+    void close_segment(segment& s);
+    void rotate();
+    void helper();
+
+public:
+    segment_log(const std::string& prefix,
+                size_t segment_size,
+                int rotate_seconds,
+                float fsync_interval);
+    ~segment_log() override;
+
+    void write(const char* buf, size_t len) override;
+    uint64_t dropped() const override { return _dropped.load(std::memory_order_relaxed); }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_SEGMENT_LOG_H */
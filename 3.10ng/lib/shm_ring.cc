@@ -0,0 +1,308 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shm_ring.h"
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#if ATOMIC_LLONG_LOCK_FREE != 2 || ATOMIC_INT_LOCK_FREE != 2
+#error "shm_ring needs lock-free atomics, which are address-free across processes"
+#endif
+
+namespace gr {
+namespace acars {
+
+static size_t page_size() { return size_t(sysconf(_SC_PAGESIZE)); }
+
+static size_t gcd(size_t a, size_t b)
+{
+    while (b != 0) {
+        size_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+static std::string shm_name(const std::string& name)
+{
+    return (!name.empty() && (name[0] == '/')) ? name : "/" + name;
+}
+
+static std::runtime_error sys_error(const std::string& what, const std::string& name)
+{
+    return std::runtime_error("acars: shm ring " + name + ": " + what + ": " +
+                              std::strerror(errno));
+}
+
+static void futex_wait(std::atomic<uint32_t>* addr, uint32_t val, int timeout_ms)
+{
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = long(timeout_ms % 1000) * 1000000L;
+    // shared between processes: no FUTEX_PRIVATE_FLAG
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, val, &ts,
+            nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>* addr)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+}
+
+shm_ring::shm_ring(const std::string& name, bool writer, int fd)
+    : _name(name),
+      _writer(writer),
+      _fd(fd),
+      _base(MAP_FAILED),
+      _length(0),
+      _h(nullptr),
+      _data(nullptr),
+      _pos(0),
+      _overruns(0),
+      _pending(0)
+{
+}
+
+// ----------------------------------------------------------------------------
+// map(): header page, then the data pages twice in a row
+// ----------------------------------------------------------------------------
+void shm_ring::map(size_t data_bytes)
+{
+    const size_t page = page_size();
+    _length = page + 2 * data_bytes;
+    _base = mmap(nullptr, _length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (_base == MAP_FAILED) {
+        throw sys_error("mmap", _name);
+    }
+    char* p = static_cast<char*>(_base);
+    // readers cannot scribble over the samples of the other processes
+    const int data_prot = _writer ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    if ((mmap(p, page, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _fd, 0) ==
+         MAP_FAILED) ||
+        (mmap(p + page, data_bytes, data_prot, MAP_SHARED | MAP_FIXED, _fd, page) ==
+         MAP_FAILED) ||
+        (mmap(p + page + data_bytes, data_bytes, data_prot, MAP_SHARED | MAP_FIXED,
+              _fd, page) == MAP_FAILED)) {
+        throw sys_error("mmap", _name);
+    }
+    _h = reinterpret_cast<header*>(p);
+    _data = p + page;
+}
+
+// ----------------------------------------------------------------------------
+// create(), attach()
+// ----------------------------------------------------------------------------
+std::unique_ptr<shm_ring>
+shm_ring::create(const std::string& name, size_t itemsize, size_t capacity)
+{
+    if ((itemsize == 0) || (capacity == 0)) {
+        throw std::invalid_argument("acars: shm ring " + name +
+                                    ": itemsize and capacity must be > 0");
+    }
+    const std::string path = shm_name(name);
+
+    // readers of a previous ring of this name move on to the new one
+    try {
+        std::unique_ptr<shm_ring> old = attach(name, 0);
+        if (old) {
+            old->_h->closed.store(1);
+            old->_h->wake.fetch_add(1);
+            futex_wake(&old->_h->wake);
+        }
+    } catch (const std::exception&) {
+        // not a ring we can read, replaced all the same
+    }
+    shm_unlink(path.c_str());
+
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw sys_error("shm_open", name);
+    }
+    std::unique_ptr<shm_ring> r(new shm_ring(name, true, fd));
+    // whole pages, for the double mapping, and whole items, so that an item
+    // sits at the same place on every lap
+    const size_t page = page_size();
+    const size_t unit = page / gcd(page, itemsize) * itemsize;
+    size_t data_bytes = (capacity * itemsize + unit - 1) / unit * unit;
+    if (ftruncate(fd, off_t(page + data_bytes)) < 0) {
+        shm_unlink(path.c_str());
+        throw sys_error("ftruncate", name);
+    }
+    r->map(data_bytes);
+
+    header* h = r->_h;
+    h->version = VERSION;
+    h->itemsize = itemsize;
+    h->capacity = data_bytes / itemsize;
+    h->data_bytes = data_bytes;
+    h->pid = int32_t(getpid());
+    // the rest of the header is zero, as the file was just created
+    h->closed.store(0);
+    h->magic.store(MAGIC);
+    return r;
+}
+
+std::unique_ptr<shm_ring> shm_ring::attach(const std::string& name, size_t itemsize)
+{
+    const std::string path = shm_name(name);
+    int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return nullptr;
+        }
+        throw sys_error("shm_open", name);
+    }
+    std::unique_ptr<shm_ring> r(new shm_ring(name, false, fd));
+
+    // the size of the data is in the header
+    const size_t page = page_size();
+    struct stat st;
+    if ((fstat(fd, &st) < 0) || (size_t(st.st_size) <= page)) {
+        return nullptr; // being created
+    }
+    void* p = mmap(nullptr, page, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        throw sys_error("mmap", name);
+    }
+    const header* h = static_cast<const header*>(p);
+    bool ready = (h->magic.load() == MAGIC);
+    uint32_t version = h->version;
+    uint64_t size = h->itemsize;
+    uint64_t data_bytes = h->data_bytes;
+    munmap(p, page);
+    if (!ready) {
+        return nullptr;
+    }
+    if ((version != VERSION) || (data_bytes + page != size_t(st.st_size)) ||
+        (size == 0) || (data_bytes % size != 0)) {
+        throw std::invalid_argument("acars: shm ring " + name + " has an unknown format");
+    }
+    if ((itemsize != 0) && (size != itemsize)) {
+        throw std::invalid_argument("acars: shm ring " + name + " holds items of " +
+                                    std::to_string(size) + " bytes, not " +
+                                    std::to_string(itemsize));
+    }
+    r->map(data_bytes);
+    r->_pos = r->_h->written.load(); // from now on
+    return r;
+}
+
+shm_ring::~shm_ring()
+{
+    if (_h && _writer) {
+        _h->closed.store(1);
+        _h->wake.fetch_add(1);
+        futex_wake(&_h->wake);
+        // unless another writer has replaced the ring meanwhile
+        const std::string path = shm_name(_name);
+        int fd = shm_open(path.c_str(), O_RDONLY, 0);
+        struct stat a, b;
+        if ((fd >= 0) && (fstat(fd, &a) == 0) && (fstat(_fd, &b) == 0) &&
+            (a.st_ino == b.st_ino)) {
+            shm_unlink(path.c_str());
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    if (_base != MAP_FAILED) {
+        munmap(_base, _length);
+    }
+    close(_fd);
+}
+
+// ----------------------------------------------------------------------------
+// write(): writer side
+// ----------------------------------------------------------------------------
+void shm_ring::write(const void* items, size_t n)
+{
+    const uint64_t w = _h->written.load(std::memory_order_relaxed);
+    // claim the items before overwriting them, so that a reader still on
+    // them notices (seqlock)
+    _h->claimed.store(w + n, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::memcpy(_data + (w * _h->itemsize) % _h->data_bytes, items, n * _h->itemsize);
+    _h->written.store(w + n, std::memory_order_seq_cst);
+    if (_h->waiters.load(std::memory_order_seq_cst) > 0) {
+        _h->wake.fetch_add(1, std::memory_order_seq_cst);
+        futex_wake(&_h->wake);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// read(), done(): reader side
+// ----------------------------------------------------------------------------
+size_t shm_ring::read(const void** items, size_t max, int timeout_ms)
+{
+    const uint64_t cap = _h->capacity;
+    for (int pass = 0; pass < 2; pass++) {
+        uint64_t w = _h->written.load(std::memory_order_acquire);
+        if (w - _pos > cap) {
+            // lapped: skip to half a ring behind the writer
+            uint64_t resume = w - cap / 2;
+            _overruns += resume - _pos;
+            _pos = resume;
+        }
+        if (w > _pos) {
+            _pending = std::min<uint64_t>(w - _pos, max);
+            *items = _data + (_pos * _h->itemsize) % _h->data_bytes;
+            return _pending;
+        }
+        if ((pass > 0) || (timeout_ms <= 0) || closed()) {
+            break;
+        }
+        // the writer wakes us only if it sees us waiting after its update
+        _h->waiters.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t v = _h->wake.load(std::memory_order_seq_cst);
+        if (_h->written.load(std::memory_order_seq_cst) == w) {
+            futex_wait(&_h->wake, v, timeout_ms);
+        }
+        _h->waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+    _pending = 0;
+    return 0;
+}
+
+bool shm_ring::done()
+{
+    // the items were read before the claim is looked at
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t c = _h->claimed.load(std::memory_order_relaxed);
+    bool ok = (c <= _pos + _h->capacity);
+    if (!ok) {
+        _overruns += _pending;
+    }
+    _pos += _pending;
+    _pending = 0;
+    return ok;
+}
+
+bool shm_ring::closed() const
+{
+    if (_h->closed.load(std::memory_order_acquire) != 0) {
+        return true;
+    }
+    // a writer that died without closing
+    return (kill(_h->pid, 0) < 0) && (errno == ESRCH);
+}
+
+} // namespace acars
+} // namespace gr
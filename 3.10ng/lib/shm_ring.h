@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_SHM_RING_H
+#define INCLUDED_ACARS_SHM_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Single-writer, multi-reader ring of samples in POSIX shared memory.
+ *
+ * The writer creates /dev/shm/<name>: a header page followed by the data,
+ * whose pages are mapped twice in a row so that any run of up to capacity()
+ * items is contiguous in memory, across the end of the ring. The data is a
+ * whole number of pages and of items: capacity() is rounded up to match. The writer
+ * never waits for the readers. It announces the items it is about to
+ * overwrite (claimed), copies them in, then publishes them (written).
+ *
+ * Each reader keeps its own position, in its own process. read() hands out
+ * a pointer into the mapping (no copy), and done() checks afterwards that
+ * the writer has not claimed any of those items in the meantime. A reader
+ * lapped by the writer loses the oldest items, which are counted as
+ * overruns, and resumes half a ring behind the writer.
+ *
+ * Readers that have nothing to read sleep on a futex in the header, woken by
+ * the writer only when some reader is waiting. A ring whose writer has
+ * exited, or been replaced by a new one of the same name, reads as closed().
+ */
+class shm_ring
+{
+public:
+    static const uint32_t MAGIC = 0x41434152; // "ACAR"
+    static const uint32_t VERSION = 1;
+
+private:
+    struct header {
+        std::atomic<uint32_t> magic; ///< set last by the writer
+        uint32_t version;
+        uint64_t itemsize;
+        uint64_t capacity;                  ///< in items
+        uint64_t data_bytes;                ///< size of one copy of the data
+        alignas(64) std::atomic<uint64_t> claimed; ///< items being written
+        std::atomic<uint64_t> written;      ///< items published
+        alignas(64) std::atomic<uint32_t> wake;    ///< futex word
+        std::atomic<uint32_t> waiters;      ///< readers sleeping on wake
+        std::atomic<uint32_t> closed;       ///< writer gone
+        int32_t pid;                        ///< writer process
+    };
+
+    std::string _name;
+    bool _writer;
+    int _fd;
+    void* _base;    ///< header page followed by the data, twice
+    size_t _length; ///< length of the reservation at _base
+    header* _h;
+    char* _data;
+    uint64_t _pos;      ///< reader: next item to read
+    uint64_t _overruns; ///< reader: items lost
+    uint64_t _pending;  ///< reader: items of the last read()
+
+    shm_ring(const std::string& name, bool writer, int fd);
+    void map(size_t data_bytes);
+
+public:
+    //! Writer: create the ring, replacing any older one of this name
+    static std::unique_ptr<shm_ring>
+    create(const std::string& name, size_t itemsize, size_t capacity);
+    //! Reader: attach to the ring of a running writer, nullptr if there is none
+    static std::unique_ptr<shm_ring> attach(const std::string& name, size_t itemsize);
+
+    ~shm_ring();
+
+    size_t itemsize() const { return _h->itemsize; }
+    uint64_t capacity() const { return _h->capacity; }
+
+    //! Writer: append n items, n <= capacity()
+    void write(const void* items, size_t n);
+
+    /*!
+     * Reader: up to \p max items available at \p *items, waiting up to
+     * \p timeout_ms for some. 0 when none came or the writer is gone.
+     */
+    size_t read(const void** items, size_t max, int timeout_ms);
+    //! Reader: release the items of the last read(), false if overrun
+    bool done();
+
+    //! Reader: the writer has closed the ring, or replaced it
+    bool closed() const;
+    uint64_t overruns() const { return _overruns; }
+    uint64_t position() const { return _pos; }
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_SHM_RING_H */
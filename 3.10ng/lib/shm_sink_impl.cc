@@ -0,0 +1,56 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shm_sink_impl.h"
+#include <gnuradio/io_signature.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace gr {
+namespace acars {
+
+shm_sink::sptr shm_sink::make(std::string name, size_t itemsize, size_t capacity)
+{
+    return gnuradio::make_block_sptr<shm_sink_impl>(name, itemsize, capacity);
+}
+
+shm_sink_impl::shm_sink_impl(std::string name, size_t itemsize, size_t capacity)
+    : gr::sync_block("shm_sink",
+                     gr::io_signature::make(1, 1, itemsize),
+                     gr::io_signature::make(0, 0, 0))
+    , _ring(shm_ring::create(name, itemsize, capacity))
+    , _itemsize(itemsize)
+    , _written(0)
+{
+    std::printf("shm ring %s: %lu items of %lu bytes\n",
+                name.c_str(),
+                (unsigned long)_ring->capacity(),
+                (unsigned long)itemsize);
+}
+
+shm_sink_impl::~shm_sink_impl() {}
+
+int shm_sink_impl::work(int noutput_items,
+                        gr_vector_const_void_star& input_items,
+                        gr_vector_void_star& output_items)
+{
+    const char* in = static_cast<const char*>(input_items[0]);
+    // at most one ring at a time, or the readers could not keep any of it
+    const int max = int(std::min<uint64_t>(_ring->capacity(), 1 << 30));
+    for (int k = 0; k < noutput_items;) {
+        int n = std::min(noutput_items - k, max);
+        _ring->write(in + size_t(k) * _itemsize, n);
+        k += n;
+    }
+    _written += noutput_items;
+    return noutput_items;
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,52 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_SHM_SINK_IMPL_H
+#define INCLUDED_ACARS_SHM_SINK_IMPL_H
+
+#include <acars/shm_sink.h>
+#include "shm_ring.h"
+#include <memory>
+
+namespace gr {
+namespace acars {
+
+class shm_sink_impl : public shm_sink
+{
+private:
+    std::unique_ptr<shm_ring> _ring;
+    size_t _itemsize;
+    uint64_t _written;
+
+public:
+    shm_sink_impl(std::string name, size_t itemsize, size_t capacity);
+    ~shm_sink_impl();
+
+    uint64_t items_written() override { return _written; }
+
+    int work(int noutput_items,
+             gr_vector_const_void_star& input_items,
+             gr_vector_void_star& output_items) override;
+};
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_SHM_SINK_IMPL_H */
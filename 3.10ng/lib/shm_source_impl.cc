@@ -0,0 +1,84 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "shm_source_impl.h"
+#include <gnuradio/io_signature.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace gr {
+namespace acars {
+
+shm_source::sptr shm_source::make(std::string name, size_t itemsize)
+{
+    return gnuradio::make_block_sptr<shm_source_impl>(name, itemsize);
+}
+
+shm_source_impl::shm_source_impl(std::string name, size_t itemsize)
+    : gr::sync_block("shm_source",
+                     gr::io_signature::make(0, 0, 0),
+                     gr::io_signature::make(1, 1, itemsize))
+    , _name(name)
+    , _itemsize(itemsize)
+    , _lost(0)
+{
+    _ring = shm_ring::attach(_name, _itemsize);
+    if (!_ring) {
+        std::printf("shm ring %s: waiting for the writer\n", _name.c_str());
+    }
+}
+
+shm_source_impl::~shm_source_impl() {}
+
+uint64_t shm_source_impl::overruns() { return _lost + (_ring ? _ring->overruns() : 0); }
+
+bool shm_source_impl::stop()
+{
+    std::printf("shm ring %s: %lu items lost\n", _name.c_str(), (unsigned long)overruns());
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// work(): one copy from the ring to the output buffer
+// ----------------------------------------------------------------------------
+// Waits are bounded (100 ms), so that the flowgraph can be stopped.
+int shm_source_impl::work(int noutput_items,
+                          gr_vector_const_void_star& input_items,
+                          gr_vector_void_star& output_items)
+{
+    if (!_ring) {
+        _ring = shm_ring::attach(_name, _itemsize);
+        if (!_ring) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return 0;
+        }
+        std::printf("shm ring %s: attached\n", _name.c_str());
+    }
+
+    const void* items;
+    size_t n = _ring->read(&items, noutput_items, 100);
+    if (n == 0) {
+        if (_ring->closed()) {
+            // the writer has gone or been restarted, look for the new ring
+            _lost += _ring->overruns();
+            _ring.reset();
+        }
+        return 0;
+    }
+    std::memcpy(output_items[0], items, n * _itemsize);
+    if (!_ring->done()) {
+        return 0; // overwritten while we copied, counted as lost
+    }
+    return int(n);
+}
+
+} // namespace acars
+} // namespace gr
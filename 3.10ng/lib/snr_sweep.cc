@@ -0,0 +1,298 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+/*
+ * Sensitivity of the decoder: the share of generated frames decoded with a
+ * valid BCS, and the decode CPU time per frame, as the Eb/N0, the bit clock
+ * error and the tone imbalance vary, for several decoder configurations:
+ *
+ *   48k        48 kHz float input, bursts on detector chunks
+ *   48k-s16    the same in 16-bit integers
+ *   44k1       44.1 kHz, fractional bit clock
+ *   12k        12 kHz, 5 samples per bit
+ *   48k-free   48 kHz, bursts anywhere: the detector finds their start
+ *
+ * Each point decodes the same frames with its own noise, so that a result
+ * only changes with the code. The table goes to stdout, or to -o. With -b,
+ * the points of a previous table are run again and the program fails if a
+ * success rate drops by more than the tolerance (-t, absolute), or, with
+ * -c, if the CPU time grows by more than that factor.
+ *
+ * usage: acars_snr_sweep [-f frames per point] [-o table] [-b baseline]
+ *                        [-t tolerance] [-c cpu factor]
+ */
+
+#include <acars/demod.h>
+#include <acars/generator.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace gr::acars;
+
+namespace {
+
+struct point {
+    std::string config;
+    std::string axis; ///< snr, clock or imbalance
+    double value;
+    int frames;
+    double success;
+    double cpu_ms;
+};
+
+struct decoder_config {
+    const char* name;
+    double rate;
+    demod::input_type input;
+    bool align;
+};
+
+const decoder_config configs[] = {
+    { "48k", 48000, demod::INPUT_FLOAT, true },
+    { "48k-s16", 48000, demod::INPUT_SHORT, true },
+    { "44k1", 44100, demod::INPUT_FLOAT, true },
+    { "12k", 12000, demod::INPUT_FLOAT, true },
+    { "48k-free", 48000, demod::INPUT_FLOAT, false },
+};
+
+// Eb/N0, clock error and imbalance away from the swept axis
+const float DEFAULT_SNR = 25.0f;
+
+const decoder_config* find_config(const std::string& name)
+{
+    for (const decoder_config& c : configs) {
+        if (name == c.name) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+double thread_cpu()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return double(t.tv_sec) + 1e-9 * double(t.tv_nsec);
+}
+
+// ----------------------------------------------------------------------------
+// run(): decode the frames of one point
+// ----------------------------------------------------------------------------
+void run(point& p)
+{
+    const decoder_config* dc = find_config(p.config);
+
+    demod::config cfg;
+    cfg.input = dc->input;
+    cfg.samp_rate = dc->rate;
+    demod d(cfg);
+
+    generator::config gc;
+    gc.samp_rate = dc->rate;
+    gc.snr_db = DEFAULT_SNR;
+    gc.gap = 0.3;
+    gc.align = dc->align ? int(d.input_multiple()) : 0;
+    if (p.axis == "snr") {
+        gc.snr_db = float(p.value);
+    } else if (p.axis == "clock") {
+        gc.clock_ppm = p.value;
+    } else if (p.axis == "imbalance") {
+        gc.imbalance_db = float(p.value);
+    }
+    // a seed per point, the same from run to run
+    uint32_t seed = 2166136261u;
+    for (char c : p.config + p.axis + std::to_string(p.value)) {
+        seed = (seed ^ uint8_t(c)) * 16777619u;
+    }
+    gc.seed = seed;
+
+    generator g(gc);
+    std::set<std::string> sent;
+    for (int k = 0; k < p.frames; k++) {
+        acars_message m;
+        char text[64];
+        std::snprintf(text, sizeof(text), "SWEEP %04d THE QUICK BROWN FOX JUMPS", k);
+        m.text = text;
+        m.msn[3] = char('A' + k % 26);
+        g.add(m);
+        std::vector<unsigned char> f = generator::frame(m);
+        std::string s;
+        for (unsigned char c : f) {
+            s += char(c & 0x7f);
+        }
+        sent.insert(s.substr(0, s.size() - 3)); // up to ETX
+    }
+    g.add_noise(0.5);
+
+    const std::vector<float>& s = g.samples();
+    std::vector<int16_t> s16;
+    if (dc->input == demod::INPUT_SHORT) {
+        s16.resize(s.size());
+        for (size_t k = 0; k < s.size(); k++) {
+            float v = std::max(-1.0f, std::min(1.0f, s[k]));
+            s16[k] = int16_t(std::lround(v * 32767.0f));
+        }
+    }
+
+    double t0 = thread_cpu();
+    if (dc->input == demod::INPUT_SHORT) {
+        d.push(s16.data(), s16.size());
+    } else {
+        d.push(s.data(), s.size());
+    }
+    d.flush();
+    double cpu = thread_cpu() - t0;
+
+    std::set<std::string> found;
+    demod_message m;
+    while (d.pull(m)) {
+        if (!m.bcs_ok) {
+            continue;
+        }
+        for (const std::string& f : sent) {
+            if (m.frame.compare(0, f.size(), f) == 0) {
+                found.insert(f);
+            }
+        }
+    }
+    p.success = double(found.size()) / p.frames;
+    p.cpu_ms = 1e3 * cpu / p.frames;
+}
+
+std::vector<point> default_points(int frames)
+{
+    std::vector<point> points;
+    for (const decoder_config& c : configs) {
+        for (double snr : { 8, 10, 12, 14, 16, 18, 20, 25, 30 }) {
+            points.push_back(point{ c.name, "snr", snr, frames, 0.0, 0.0 });
+        }
+    }
+    for (const char* c : { "48k", "44k1" }) {
+        for (double ppm : { -1000, -300, 0, 300, 1000 }) {
+            points.push_back(point{ c, "clock", ppm, frames, 0.0, 0.0 });
+        }
+    }
+    for (double db : { -12, -9, -6, -3, 0, 3 }) {
+        points.push_back(point{ "48k", "imbalance", db, frames, 0.0, 0.0 });
+    }
+    return points;
+}
+
+bool read_table(const char* path, std::vector<point>& points)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::perror(path);
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || (line[0] == '#')) {
+            continue;
+        }
+        std::istringstream ls(line);
+        point p;
+        if (!(ls >> p.config >> p.axis >> p.value >> p.frames >> p.success >> p.cpu_ms) ||
+            !find_config(p.config) || (p.frames <= 0)) {
+            std::fprintf(stderr, "%s: bad line: %s\n", path, line.c_str());
+            return false;
+        }
+        points.push_back(p);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int frames = 20;
+    const char* output = nullptr;
+    const char* baseline = nullptr;
+    double tolerance = 0.1;
+    double cpu_factor = 0.0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:o:b:t:c:")) != -1) {
+        switch (opt) {
+        case 'f':
+            frames = std::atoi(optarg);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'b':
+            baseline = optarg;
+            break;
+        case 't':
+            tolerance = std::atof(optarg);
+            break;
+        case 'c':
+            cpu_factor = std::atof(optarg);
+            break;
+        default:
+            std::fprintf(stderr,
+                         "usage: %s [-f frames per point] [-o table] [-b baseline] "
+                         "[-t tolerance] [-c cpu factor]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<point> reference;
+    if (baseline && !read_table(baseline, reference)) {
+        return 2;
+    }
+    std::vector<point> points = baseline ? reference : default_points(frames);
+
+    FILE* table = output ? std::fopen(output, "w") : stdout;
+    if (!table) {
+        std::perror(output);
+        return 2;
+    }
+
+    std::fprintf(table,
+                 "# acars_snr_sweep: frames decoded with a valid BCS, decode CPU per frame\n"
+                 "# config    axis       value frames  success   cpu_ms\n");
+    int regressions = 0;
+    for (size_t k = 0; k < points.size(); k++) {
+        point& p = points[k];
+        run(p);
+        std::fprintf(table, "%-11s %-9s %7.1f %6d %8.3f %8.3f\n", p.config.c_str(),
+                     p.axis.c_str(), p.value, p.frames, p.success, p.cpu_ms);
+        std::fflush(table);
+        if (!baseline) {
+            continue;
+        }
+        const point& r = reference[k];
+        if (p.success < r.success - tolerance) {
+            std::fprintf(stderr, "regression: %s %s %.1f: success %.3f, was %.3f\n",
+                         p.config.c_str(), p.axis.c_str(), p.value, p.success, r.success);
+            regressions++;
+        }
+        if ((cpu_factor > 0.0) && (p.cpu_ms > r.cpu_ms * cpu_factor)) {
+            std::fprintf(stderr, "regression: %s %s %.1f: %.3f ms per frame, was %.3f\n",
+                         p.config.c_str(), p.axis.c_str(), p.value, p.cpu_ms, r.cpu_ms);
+            regressions++;
+        }
+    }
+    if (table != stdout) {
+        std::fclose(table);
+    }
+
+    if (baseline) {
+        std::fprintf(stderr, "%zu points, regressions: %d\n", points.size(), regressions);
+    }
+    return regressions ? 1 : 0;
+}
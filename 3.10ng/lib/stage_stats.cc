@@ -0,0 +1,171 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "stage_stats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace gr {
+namespace acars {
+
+// ----------------------------------------------------------------------------
+// latency_histogram
+// ----------------------------------------------------------------------------
+latency_histogram::latency_histogram() { reset(); }
+
+// Octave of ns, then the SUB bits below its leading one
+int latency_histogram::bucket(uint64_t ns)
+{
+    if (ns < (1u << SUB)) {
+        return int(ns);
+    }
+    int octave = 63 - __builtin_clzll(ns);
+    int b = ((octave - SUB + 1) << SUB) + int((ns >> (octave - SUB)) & ((1u << SUB) - 1));
+    return (b < BUCKETS) ? b : BUCKETS - 1;
+}
+
+double latency_histogram::upper(int b)
+{
+    if (b < (1 << SUB)) {
+        return double(b + 1);
+    }
+    int octave = (b >> SUB) + SUB - 1;
+    double step = std::ldexp(1.0, octave - SUB);
+    return std::ldexp(1.0, octave) + step * double((b & ((1 << SUB) - 1)) + 1);
+}
+
+void latency_histogram::record(int64_t ns)
+{
+    uint64_t v = (ns > 0) ? uint64_t(ns) : 0;
+    _bucket[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(v, std::memory_order_relaxed);
+    uint64_t m = _max.load(std::memory_order_relaxed);
+    while ((v > m) && !_max.compare_exchange_weak(m, v, std::memory_order_relaxed)) {
+    }
+}
+
+void latency_histogram::reset()
+{
+    for (auto& b : _bucket) {
+        b.store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+// The percentiles are the upper bounds of their buckets, at most the maximum
+stage_latency latency_histogram::summary(const char* name) const
+{
+    stage_latency s = {};
+    s.name = name;
+    uint64_t counts[BUCKETS];
+    uint64_t total = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        counts[b] = _bucket[b].load(std::memory_order_relaxed);
+        total += counts[b];
+    }
+    s.count = total;
+    if (total == 0) {
+        return s;
+    }
+    s.max_us = 1e-3 * double(_max.load(std::memory_order_relaxed));
+    s.mean_us = 1e-3 * double(_sum.load(std::memory_order_relaxed)) /
+                double(_count.load(std::memory_order_relaxed));
+    double* p[] = { &s.p50_us, &s.p90_us, &s.p99_us };
+    const double rank[] = { 0.5, 0.9, 0.99 };
+    int b = 0;
+    uint64_t seen = counts[0];
+    for (int k = 0; k < 3; k++) {
+        while ((b + 1 < BUCKETS) && (double(seen) < rank[k] * double(total))) {
+            seen += counts[++b];
+        }
+        *p[k] = std::min(1e-3 * upper(b), s.max_us);
+    }
+    return s;
+}
+
+void latency_histogram::cumulative(
+    const double* le, int n, uint64_t* counts, double& sum, uint64_t& count) const
+{
+    std::fill(counts, counts + n, 0);
+    count = 0;
+    int k = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        uint64_t c = _bucket[b].load(std::memory_order_relaxed);
+        count += c;
+        while ((k < n) && (upper(b) > le[k])) {
+            counts[k++] = count - c;
+        }
+    }
+    for (; k < n; k++) {
+        counts[k] = count;
+    }
+    sum = double(_sum.load(std::memory_order_relaxed));
+}
+
+// ----------------------------------------------------------------------------
+// stage_stats
+// ----------------------------------------------------------------------------
+#ifdef ACARS_STAGE_TIMING
+stage_stats::stage_stats()
+{
+    static std::atomic<int> channels(0);
+    _channel = channels.fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+const char* stage_stats::name(stage s)
+{
+    static const char* names[STAGE_COUNT] = { "push",  "detect", "queue",  "fft",
+                                              "slice", "frame",  "output", "latency" };
+    return names[s];
+}
+
+std::vector<stage_latency> stage_stats::summary() const
+{
+    std::vector<stage_latency> v;
+#ifdef ACARS_STAGE_TIMING
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        v.push_back(_h[s].summary(name(stage(s))));
+    }
+#endif
+    return v;
+}
+
+void stage_stats::histogram(
+    stage s, const double* le, int n, uint64_t* counts, double& sum, uint64_t& count) const
+{
+#ifdef ACARS_STAGE_TIMING
+    std::vector<double> ns(le, le + n);
+    for (double& v : ns) {
+        v *= 1e9;
+    }
+    _h[s].cumulative(ns.data(), n, counts, sum, count);
+    sum *= 1e-9;
+#else
+    (void)s;
+    std::fill(counts, counts + n, 0);
+    sum = 0.0;
+    count = 0;
+#endif
+}
+
+void stage_stats::reset()
+{
+#ifdef ACARS_STAGE_TIMING
+    for (auto& h : _h) {
+        h.reset();
+    }
+#endif
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,178 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_STAGE_STATS_H
+#define INCLUDED_ACARS_STAGE_STATS_H
+
+#include "trace_buffer.h"
+#include <acars/demod.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+//! Timed stages of a channel, in the order of a burst through the decoder
+enum stage {
+    STAGE_PUSH = 0, ///< a call of demod::push(), so the block's work()
+    STAGE_DETECT,   ///< one chunk through the detector
+    STAGE_QUEUE,    ///< a burst waiting for a decode thread
+    STAGE_FFT,      ///< tone correlation of a burst, plans included
+    STAGE_SLICE,    ///< bit decisions
+    STAGE_FRAME,    ///< characters and BCS check
+    STAGE_OUTPUT,   ///< parsing, log, feed and listener of a burst
+    STAGE_LATENCY,  ///< a burst from its detection to the end of its output
+    STAGE_COUNT
+};
+
+//! Steady clock, in ns
+inline int64_t stage_clock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/*!
+ * \brief Log-bucketed histogram of durations, updated without locks.
+ *
+ * Four buckets per octave of nanoseconds, so that a percentile is known to
+ * within 25 %. Every counter is a relaxed atomic: record() may be called
+ * from any thread, and a reader sees each counter at some recent value.
+ */
+class latency_histogram
+{
+public:
+    static const int SUB = 2;           ///< log2 of the buckets per octave
+    static const int BUCKETS = 48 << SUB; ///< up to 2^48 ns, 3 days
+
+private:
+    std::atomic<uint64_t> _bucket[BUCKETS];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum; ///< ns
+    std::atomic<uint64_t> _max; ///< ns
+
+    static int bucket(uint64_t ns);
+    static double upper(int bucket); ///< ns
+
+public:
+    latency_histogram();
+
+    void record(int64_t ns);
+    void reset();
+    //! Count, mean, percentiles and maximum
+    stage_latency summary(const char* name) const;
+    /*!
+     * \brief Cumulative counts of the durations up to each of the \p n
+     * increasing bounds \p le (ns), with the sum (ns) and count of all.
+     * A bucket counts under the first bound not below its upper end.
+     */
+    void cumulative(const double* le, int n, uint64_t* counts, double& sum, uint64_t& count)
+        const;
+};
+
+/*!
+ * \brief Latency histograms of the stages of a channel.
+ *
+ * Built with ACARS_STAGE_TIMING (the ENABLE_STAGE_TIMING option), else it
+ * is empty and the timers compile to nothing. While tracing, the timed
+ * stages also go to the trace, with the number of the channel.
+ */
+class stage_stats
+{
+#ifdef ACARS_STAGE_TIMING
+private:
+    latency_histogram _h[STAGE_COUNT];
+    int _channel; ///< in the order the channels were made, for the trace
+
+public:
+    stage_stats();
+
+    void record(stage s, int64_t ns) { _h[s].record(ns); }
+    //! Histogram and trace
+    void record(stage s, int64_t start, int64_t ns)
+    {
+        _h[s].record(ns);
+        if (trace_enabled()) {
+            trace_record(name(s), _channel, start, ns);
+        }
+    }
+#else
+public:
+    void record(stage, int64_t) {}
+#endif
+
+public:
+    static const char* name(stage s);
+
+    //! One entry per stage, none without ACARS_STAGE_TIMING
+    std::vector<stage_latency> summary() const;
+    //! latency_histogram::cumulative() of a stage, bounds and sum in seconds
+    void histogram(
+        stage s, const double* le, int n, uint64_t* counts, double& sum, uint64_t& count) const;
+    void reset();
+};
+
+/*!
+ * \brief Times its scope, or up to stop(), into a stage of \p stats if not
+ * nullptr.
+ */
+#ifdef ACARS_STAGE_TIMING
+class stage_timer
+{
+private:
+    stage_stats* _stats;
+    stage _stage;
+    int64_t _t0;
+
+public:
+    stage_timer(stage_stats* stats, stage s)
+        : _stats(stats), _stage(s), _t0(stats ? stage_clock() : 0)
+    {
+    }
+    ~stage_timer() { stop(); }
+
+    //! Record the time now rather than at the end of the scope
+    void stop()
+    {
+        if (_stats) {
+            _stats->record(_stage, _t0, stage_clock() - _t0);
+            _stats = nullptr;
+        }
+    }
+
+    stage_timer(const stage_timer&) = delete;
+    stage_timer& operator=(const stage_timer&) = delete;
+};
+#else
+class stage_timer
+{
+public:
+    stage_timer(stage_stats*, stage) {}
+    void stop() {}
+};
+#endif
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_STAGE_STATS_H */
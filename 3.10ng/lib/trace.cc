@@ -0,0 +1,192 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "trace_buffer.h"
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gr {
+namespace acars {
+
+std::atomic<bool> trace_on(false);
+
+namespace {
+
+struct trace_event {
+    const char* name;
+    int channel;
+    int64_t start;
+    int64_t duration;
+};
+
+// Events of one thread: written by it only, read by trace_write()
+struct thread_buffer {
+    long tid;
+    std::string name;
+    std::vector<trace_event> ring;
+    std::atomic<uint64_t> head; ///< events written since the start
+    unsigned generation;        ///< of the capacity the ring was made with
+
+    thread_buffer(long t, const std::string& n, size_t capacity, unsigned g)
+        : tid(t), name(n), ring(capacity), head(0), generation(g)
+    {
+    }
+};
+
+std::mutex registry_mutex;
+// kept to the end of the process, so that the events of the threads that
+// have exited are still written
+std::vector<std::unique_ptr<thread_buffer>> buffers;
+size_t capacity = 65536;
+// changes with capacity: the threads then move to rings of the new size
+std::atomic<unsigned> generation(0);
+std::string exit_path; ///< ACARS_TRACE
+
+thread_local thread_buffer* this_thread = nullptr;
+thread_local std::string this_thread_name;
+
+thread_buffer* register_thread()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    long tid = long(syscall(SYS_gettid));
+    std::string name = this_thread_name.empty() ? "thread " + std::to_string(tid)
+                                                : this_thread_name;
+    buffers.emplace_back(new thread_buffer(
+        tid, name, capacity, generation.load(std::memory_order_relaxed)));
+    return buffers.back().get();
+}
+
+void json_string(FILE* f, const std::string& s)
+{
+    std::fputc('"', f);
+    for (char c : s) {
+        if ((c == '"') || (c == '\\')) {
+            std::fputc('\\', f);
+        }
+        if (uint8_t(c) >= 0x20) {
+            std::fputc(c, f);
+        }
+    }
+    std::fputc('"', f);
+}
+
+void write_at_exit() { trace_write(exit_path); }
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// Recording
+// ----------------------------------------------------------------------------
+void trace_record(const char* name, int channel, int64_t start, int64_t duration)
+{
+    // a ring is only ever written by its thread, so it is not resized: after
+    // a new trace_start() size the thread records into a new one, the old
+    // one staying registered for its events
+    thread_buffer* b = this_thread;
+    if (!b || (b->generation != generation.load(std::memory_order_relaxed))) {
+        b = this_thread = register_thread();
+    }
+    uint64_t h = b->head.load(std::memory_order_relaxed);
+    trace_event& e = b->ring[h % b->ring.size()];
+    e.name = name;
+    e.channel = channel;
+    e.start = start;
+    e.duration = duration;
+    b->head.store(h + 1, std::memory_order_release);
+}
+
+void trace_thread_name(const std::string& name) { this_thread_name = name; }
+
+void trace_start(size_t events_per_thread)
+{
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        size_t n = (events_per_thread > 0) ? events_per_thread : 1;
+        if (n != capacity) {
+            capacity = n;
+            generation.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    trace_on.store(true, std::memory_order_relaxed);
+}
+
+void trace_stop() { trace_on.store(false, std::memory_order_relaxed); }
+
+bool trace_active() { return trace_enabled(); }
+
+void trace_from_environment()
+{
+    static std::once_flag once;
+    std::call_once(once, [] {
+        const char* path = std::getenv("ACARS_TRACE");
+        if (path && *path) {
+            exit_path = path;
+            trace_start();
+            std::atexit(write_at_exit);
+        }
+    });
+}
+
+// ----------------------------------------------------------------------------
+// trace_write(): Chrome trace event JSON
+// ----------------------------------------------------------------------------
+// A ring may be written while it is copied: the events the writer may have
+// overwritten meanwhile are left out, including the slot of the event it
+// may be writing, at its head after the copy.
+bool trace_write(const std::string& path)
+{
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::perror(path.c_str());
+        return false;
+    }
+    const long pid = long(getpid());
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    const char* sep = "";
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::vector<trace_event> events;
+    for (const auto& b : buffers) {
+        const uint64_t size = b->ring.size();
+        uint64_t head = b->head.load(std::memory_order_acquire);
+        uint64_t first = (head > size) ? head - size : 0;
+        events.clear();
+        for (uint64_t k = first; k < head; k++) {
+            events.push_back(b->ring[k % size]);
+        }
+        uint64_t after = b->head.load(std::memory_order_acquire);
+        uint64_t valid = (after + 1 > size) ? after + 1 - size : 0;
+
+        std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%ld,"
+                        "\"args\":{\"name\":", sep, pid, b->tid);
+        json_string(f, b->name);
+        std::fprintf(f, "}}");
+        sep = ",\n";
+        for (uint64_t k = std::max(first, valid); k < head; k++) {
+            const trace_event& e = events[k - first];
+            std::fprintf(f,
+                         ",\n{\"name\":\"%s\",\"cat\":\"acars\",\"ph\":\"X\",\"ts\":%.3f,"
+                         "\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld,\"args\":{\"channel\":%d}}",
+                         e.name, 1e-3 * double(e.start), 1e-3 * double(e.duration), pid,
+                         b->tid, e.channel);
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+    bool ok = !std::ferror(f);
+    ok = (std::fclose(f) == 0) && ok;
+    return ok;
+}
+
+} // namespace acars
+} // namespace gr
@@ -0,0 +1,54 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2022 gr-acars author.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_ACARS_TRACE_BUFFER_H
+#define INCLUDED_ACARS_TRACE_BUFFER_H
+
+#include <acars/trace.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace gr {
+namespace acars {
+
+/*!
+ * \brief Recording side of the tracer of acars/trace.h.
+ *
+ * trace_record() appends to the ring of the calling thread, allocated at
+ * its first event; the only shared state it reads is the trace_on flag.
+ */
+extern std::atomic<bool> trace_on;
+
+inline bool trace_enabled() { return trace_on.load(std::memory_order_relaxed); }
+
+//! A stage \p name of \p channel, from \p start for \p duration (steady ns)
+void trace_record(const char* name, int channel, int64_t start, int64_t duration);
+
+//! Name of the calling thread on the timeline, before its first event
+void trace_thread_name(const std::string& name);
+
+//! Start tracing if ACARS_TRACE is set, once per process
+void trace_from_environment();
+
+} // namespace acars
+} // namespace gr
+
+#endif /* INCLUDED_ACARS_TRACE_BUFFER_H */
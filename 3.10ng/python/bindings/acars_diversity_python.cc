@@ -0,0 +1,67 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of GNU Radio.
+ *
+ * NOTE: The lines with "BINDTOOL_*" comments are for the binding tool
+ * (gr_modtool) and can be automatically regenerated. If you manually
+ * edit this file, set BINDTOOL_GEN_AUTOMATIC(0) to avoid overwriting.
+ */
+
+/***********************************************************************************/
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(acars_diversity.h)                                         */
+/* BINDTOOL_HEADER_FILE_HASH(00000000000000000000000000000000)                     */
+/***********************************************************************************/
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+// For succinctness
+namespace py = pybind11;
+
+#include <acars/acars_diversity.h>
+// pydoc.h is automatically generated during the build (via doxygen & gr_modtool)
+#include <acars_diversity_pydoc.h>
+
+// This function will be called by python_bindings.cc in PYBIND11_MODULE(acars_python, ...)
+void bind_acars_diversity(py::module& m)
+{
+    using acars_diversity = ::gr::acars::acars_diversity;
+
+    py::class_<acars_diversity, gr::sync_block, gr::block, gr::basic_block,
+        std::shared_ptr<acars_diversity>>(m, "acars_diversity", D(acars_diversity))
+
+        // Constructor (acars_diversity::make)
+        .def(py::init(&acars_diversity::make),
+             py::arg("seuil"),
+             py::arg("receivers"),
+             py::arg("samp_rate"),
+             py::arg("filename"),
+             py::arg("window") = 0.1,
+             py::arg("feed") = "",
+             py::arg("dedup_window") = 0,
+             py::arg("dedup_group") = "acars",
+             py::arg("decode_threads") = -1,
+             py::arg("decode_queue") = 16,
+             D(acars_diversity, make)
+        )
+
+        .def("set_seuil",
+             &acars_diversity::set_seuil,
+             py::arg("threshold"),
+             D(acars_diversity, set_seuil)
+        )
+
+        .def("transmissions",
+             &acars_diversity::transmissions,
+             D(acars_diversity, transmissions))
+        .def("combined",
+             &acars_diversity::combined,
+             D(acars_diversity, combined))
+        .def("dropped_bursts",
+             &acars_diversity::dropped_bursts,
+             D(acars_diversity, dropped_bursts));
+}
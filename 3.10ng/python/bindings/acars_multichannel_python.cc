@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of GNU Radio.
+ *
+ * NOTE: The lines with "BINDTOOL_*" comments are for the binding tool
+ * (gr_modtool) and can be automatically regenerated. If you manually
+ * edit this file, set BINDTOOL_GEN_AUTOMATIC(0) to avoid overwriting.
+ */
+
+/***********************************************************************************/
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(acars_multichannel.h)                                      */
+/* BINDTOOL_HEADER_FILE_HASH(00000000000000000000000000000000)                     */
+/***********************************************************************************/
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+// For succinctness
+namespace py = pybind11;
+
+#include <acars/acars_multichannel.h>
+// pydoc.h is automatically generated during the build (via doxygen & gr_modtool)
+#include <acars_multichannel_pydoc.h>
+
+// This function will be called by python_bindings.cc in PYBIND11_MODULE(acars_python, ...)
+void bind_acars_multichannel(py::module& m)
+{
+    using acars_multichannel = ::gr::acars::acars_multichannel;
+
+    py::class_<acars_multichannel, gr::sync_block, gr::block, gr::basic_block,
+        std::shared_ptr<acars_multichannel>>(m, "acars_multichannel", D(acars_multichannel))
+
+        // Constructor (acars_multichannel::make)
+        .def(py::init(&acars_multichannel::make),
+             py::arg("seuil"),
+             py::arg("samp_rate"),
+             py::arg("center_freq"),
+             py::arg("channels"),
+             py::arg("filename"),
+             py::arg("saveall") = false,
+             py::arg("channel_spacing") = 25000,
+             py::arg("feed") = "",
+             py::arg("dedup_window") = 0,
+             py::arg("dedup_group") = "acars",
+             py::arg("decode_threads") = -1,
+             py::arg("decode_queue") = 16,
+             D(acars_multichannel, make)
+        )
+
+        .def("set_seuil",
+             &acars_multichannel::set_seuil,
+             py::arg("threshold"),
+             D(acars_multichannel, set_seuil)
+        )
+
+        .def("queue_depth",
+             &acars_multichannel::queue_depth,
+             D(acars_multichannel, queue_depth))
+        .def("dropped_bursts",
+             &acars_multichannel::dropped_bursts,
+             D(acars_multichannel, dropped_bursts));
+}
@@ -32,13 +32,48 @@ void bind_acars(py::module& m)
     using acars = ::gr::acars::acars;
 
     py::class_<acars, gr::sync_block, gr::block, gr::basic_block,
-        std::shared_ptr<acars>>(m, "acars", D(acars))
+        std::shared_ptr<acars>> acars_class(m, "acars", D(acars));
 
+    py::enum_<acars::dump_format>(acars_class, "dump_format")
+        .value("DUMP_TEXT", acars::DUMP_TEXT)
+        .value("DUMP_SIGMF", acars::DUMP_SIGMF)
+        .export_values();
+
+    py::enum_<acars::input_type>(acars_class, "input_type")
+        .value("INPUT_FLOAT", acars::INPUT_FLOAT)
+        .value("INPUT_COMPLEX", acars::INPUT_COMPLEX)
+        .value("INPUT_SHORT", acars::INPUT_SHORT)
+        .value("INPUT_CHAR", acars::INPUT_CHAR)
+        .export_values();
+
+    py::enum_<acars::capture_policy>(acars_class, "capture_policy")
+        .value("CAPTURE_ALL", acars::CAPTURE_ALL)
+        .value("CAPTURE_FAILED", acars::CAPTURE_FAILED)
+        .export_values();
+
+    acars_class
         // Constructor (acars::make)
         .def(py::init(&acars::make),
              py::arg("seuil"),
              py::arg("filename"),
              py::arg("saveall"),
+             py::arg("segment_size") = 0,
+             py::arg("rotate_seconds") = 0,
+             py::arg("fsync_interval") = 1.0,
+             py::arg("format") = acars::DUMP_TEXT,
+             py::arg("policy") = acars::CAPTURE_ALL,
+             py::arg("capture_depth") = 8,
+             py::arg("capture_sample") = 0,
+             py::arg("feed") = "",
+             py::arg("feed_interval") = 0.001,
+             py::arg("dedup_window") = 0,
+             py::arg("dedup_group") = "acars",
+             py::arg("decode_threads") = -1,
+             py::arg("decode_queue") = 16,
+             py::arg("input") = acars::INPUT_FLOAT,
+             py::arg("samp_rate") = 48000,
+             py::arg("stats_interval") = 10,
+             py::arg("metrics_port") = 0,
              D(acars, make)
         )
 
@@ -47,5 +82,18 @@ void bind_acars(py::module& m)
              &acars::set_seuil,
              py::arg("threshold"),
              D(acars, set_seuil)
-        );
+        )
+
+        .def("queue_depth", &acars::queue_depth, D(acars, queue_depth))
+        .def("dropped_bursts", &acars::dropped_bursts, D(acars, dropped_bursts))
+        .def("stage_report",
+             &acars::stage_report,
+             py::arg("reset") = false,
+             D(acars, stage_report))
+        .def("start_trace",
+             &acars::start_trace,
+             py::arg("events_per_thread") = 65536,
+             D(acars, start_trace))
+        .def("stop_trace", &acars::stop_trace, D(acars, stop_trace))
+        .def("write_trace", &acars::write_trace, py::arg("path"), D(acars, write_trace));
 }
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2022 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+#include "pydoc_macros.h"
+#define D(...) DOC(gr,acars, __VA_ARGS__ )
+/*
+  This file contains placeholders for docstrings for the Python bindings.
+  Do not edit! These were automatically extracted during the binding process
+  and will be overwritten during the build process
+ */
+
+
+ 
+ static const char *__doc_gr_acars_acars_multichannel = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_multichannel_acars_multichannel_0 = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_multichannel_acars_multichannel_1 = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_multichannel_make = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_multichannel_set_seuil = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_multichannel_queue_depth = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_multichannel_dropped_bursts = R"doc()doc";
+
+  
@@ -30,4 +30,22 @@
 
  static const char *__doc_gr_acars_acars_set_seuil = R"doc()doc";
 
+
+ static const char *__doc_gr_acars_acars_queue_depth = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_dropped_bursts = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_stage_report = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_start_trace = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_stop_trace = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_acars_write_trace = R"doc()doc";
+
   
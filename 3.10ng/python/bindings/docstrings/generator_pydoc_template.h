@@ -0,0 +1,45 @@
+/*
+ * Copyright 2022 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ */
+#include "pydoc_macros.h"
+#define D(...) DOC(gr,acars, __VA_ARGS__ )
+/*
+  This file contains placeholders for docstrings for the Python bindings.
+  Do not edit! These were automatically extracted during the binding process
+  and will be overwritten during the build process
+ */
+
+
+ 
+ static const char *__doc_gr_acars_acars_message = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator_generator = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator_frame = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator_add_0 = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator_add_1 = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator_add_noise = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator_samples = R"doc()doc";
+
+
+ static const char *__doc_gr_acars_generator_clear = R"doc()doc";
+
+  
@@ -0,0 +1,104 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of GNU Radio.
+ *
+ * NOTE: The lines with "BINDTOOL_*" comments are for the binding tool
+ * (gr_modtool) and can be automatically regenerated. If you manually
+ * edit this file, set BINDTOOL_GEN_AUTOMATIC(0) to avoid overwriting.
+ */
+
+/***********************************************************************************/
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(generator.h)                                               */
+/* BINDTOOL_HEADER_FILE_HASH(00000000000000000000000000000000)                     */
+/***********************************************************************************/
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+// For succinctness
+namespace py = pybind11;
+
+#include <acars/generator.h>
+// pydoc.h is automatically generated during the build (via doxygen & gr_modtool)
+#include <generator_pydoc.h>
+
+// This function will be called by python_bindings.cc in PYBIND11_MODULE(acars_python, ...)
+void bind_generator(py::module& m)
+{
+    using acars_message = ::gr::acars::acars_message;
+    using generator = ::gr::acars::generator;
+
+    py::class_<acars_message>(m, "acars_message", D(acars_message))
+        .def(py::init<>())
+        .def_readwrite("mode", &acars_message::mode)
+        .def_readwrite("address", &acars_message::address)
+        .def_readwrite("ack", &acars_message::ack)
+        .def_readwrite("label", &acars_message::label)
+        .def_readwrite("block_id", &acars_message::block_id)
+        .def_readwrite("msn", &acars_message::msn)
+        .def_readwrite("flight", &acars_message::flight)
+        .def_readwrite("text", &acars_message::text)
+        .def_readwrite("etb", &acars_message::etb);
+
+    py::class_<generator> generator_class(m, "generator", D(generator));
+
+    py::class_<generator::config>(generator_class, "config")
+        .def(py::init<>())
+        .def_readwrite("samp_rate", &generator::config::samp_rate)
+        .def_readwrite("amplitude", &generator::config::amplitude)
+        .def_readwrite("snr_db", &generator::config::snr_db)
+        .def_readwrite("imbalance_db", &generator::config::imbalance_db)
+        .def_readwrite("clock_ppm", &generator::config::clock_ppm)
+        .def_readwrite("drift_ppm_s", &generator::config::drift_ppm_s)
+        .def_readwrite("dc", &generator::config::dc)
+        .def_readwrite("prekey_bits", &generator::config::prekey_bits)
+        .def_readwrite("gap", &generator::config::gap)
+        .def_readwrite("align", &generator::config::align)
+        .def_readwrite("seed", &generator::config::seed);
+
+    generator_class
+        .def(py::init<const generator::config&>(),
+             py::arg("cfg") = generator::config(),
+             D(generator, generator))
+
+        .def_static("frame",
+                    [](const acars_message& msg) {
+                        std::vector<unsigned char> f = generator::frame(msg);
+                        return py::bytes(reinterpret_cast<const char*>(f.data()),
+                                         f.size());
+                    },
+                    py::arg("msg"),
+                    D(generator, frame))
+
+        .def("add",
+             py::overload_cast<const acars_message&>(&generator::add),
+             py::arg("msg"),
+             D(generator, add, 0))
+
+        .def("add_frame",
+             [](generator& g, py::bytes frame) {
+                 std::string s = frame;
+                 return g.add(std::vector<unsigned char>(s.begin(), s.end()));
+             },
+             py::arg("frame"),
+             D(generator, add, 1))
+
+        .def("add_noise",
+             &generator::add_noise,
+             py::arg("seconds"),
+             D(generator, add_noise))
+
+        // a copy, as a float32 numpy array
+        .def("samples",
+             [](const generator& g) {
+                 const std::vector<float>& s = g.samples();
+                 return py::array_t<float>(s.size(), s.data());
+             },
+             D(generator, samples))
+
+        .def("clear", &generator::clear, D(generator, clear));
+}
@@ -15,7 +15,12 @@ namespace py = pybind11;
 
 /**************************************/
 // BINDING_FUNCTION_PROTOTYPES(
-//     void bind_acars(py::module& m);
+    void bind_acars(py::module& m);
+    void bind_acars_multichannel(py::module& m);
+    void bind_acars_diversity(py::module& m);
+    void bind_shm_sink(py::module& m);
+    void bind_shm_source(py::module& m);
+    void bind_generator(py::module& m);
 // ) END BINDING_FUNCTION_PROTOTYPES
 /**************************************/
 
@@ -39,6 +44,11 @@ PYBIND11_MODULE(acars_python, m)
     /**************************************/
     // BINDING_FUNCTION_CALLS(
     bind_acars(m);
+    bind_acars_multichannel(m);
+    bind_acars_diversity(m);
+    bind_shm_sink(m);
+    bind_shm_source(m);
+    bind_generator(m);
     // ) END BINDING_FUNCTION_CALLS
     /**************************************/
 }
@@ -0,0 +1,48 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * This file is part of GNU Radio.
+ *
+ * NOTE: The lines with "BINDTOOL_*" comments are for the binding tool
+ * (gr_modtool) and can be automatically regenerated. If you manually
+ * edit this file, set BINDTOOL_GEN_AUTOMATIC(0) to avoid overwriting.
+ */
+
+/***********************************************************************************/
+/* BINDTOOL_GEN_AUTOMATIC(0)                                                       */
+/* BINDTOOL_USE_PYGCCXML(0)                                                        */
+/* BINDTOOL_HEADER_FILE(shm_sink.h)                                               */
+/* BINDTOOL_HEADER_FILE_HASH(00000000000000000000000000000000)                     */
+/***********************************************************************************/
+
+#include <pybind11/complex.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+// For succinctness
+namespace py = pybind11;
+
+#include <acars/shm_sink.h>
+// pydoc.h is automatically generated during the build (via doxygen & gr_modtool)
+#include <shm_sink_pydoc.h>
+
+// This function will be called by python_bindings.cc in PYBIND11_MODULE(acars_python, ...)
+void bind_shm_sink(py::module& m)
+{
+    using shm_sink = ::gr::acars::shm_sink;
+
+    py::class_<shm_sink, gr::sync_block, gr::block, gr::basic_block,
+        std::shared_ptr<shm_sink>>(m, "shm_sink", D(shm_sink))
+
+        // Constructor (shm_sink::make)
+        .def(py::init(&shm_sink::make),
+             py::arg("name"),
+             py::arg("itemsize"),
+             py::arg("capacity") = 1 << 20,
+             D(shm_sink, make)
+        )
+
+        .def("items_written",
+             &shm_sink::items_written,
+             D(shm_sink, items_written));
+}